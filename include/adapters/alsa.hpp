@@ -70,6 +70,7 @@ class alsa_ctl_interface {
   bool wait(int timeout = -1);
   bool test_device_plugged();
   void process_events();
+  vector<int> get_file_descriptors();
 
  private:
   int m_numid{0};
@@ -97,6 +98,7 @@ class alsa_mixer {
 
   bool wait(int timeout = -1);
   int process_events();
+  vector<int> get_file_descriptors();
 
   int get_volume();
   int get_normalized_volume();
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <chrono>
+#include <mutex>
 
 #include <arpa/inet.h>
 #include <ifaddrs.h>
@@ -13,6 +14,10 @@
 #include "common.hpp"
 #include "config.hpp"
 #include "errors.hpp"
+#include "utils/concurrency.hpp"
+#include "utils/functional.hpp"
+
+struct nlmsghdr;
 
 POLYBAR_NS
 
@@ -36,7 +41,7 @@ namespace net {
     }
   };
 
-  using bytes_t = unsigned int;
+  using bytes_t = unsigned long long;
 
   struct link_activity {
     bytes_t transmitted{0};
@@ -53,6 +58,13 @@ namespace net {
   // }}}
   // class : network {{{
 
+  /**
+   * Network interface state kept up to date by an rtnetlink socket
+   *
+   * Link and address changes are received as notifications on the
+   * socket, while the traffic counters are requested for the
+   * configured interface only, when querying
+   */
   class network {
    public:
     explicit network(string interface);
@@ -60,18 +72,34 @@ namespace net {
 
     virtual bool query(bool accumulate = false);
     virtual bool connected() const = 0;
-    virtual bool ping() const;
+
+    bool process_events();
+    int get_file_descriptor() const;
 
     string ip() const;
     string downspeed(int minwidth = 3) const;
     string upspeed(int minwidth = 3) const;
+    float downspeed_rate() const;
+    float upspeed_rate() const;
 
    protected:
     void check_tuntap();
     bool test_interface() const;
+    uint32_t request(uint16_t type, uint16_t flags);
+    bool receive(bool accumulate = false);
+    bool parse_link(const struct nlmsghdr* msg, bool accumulate);
+    bool parse_address(const struct nlmsghdr* msg);
+    float speedrate(float bytes_diff) const;
     string format_speedrate(float bytes_diff, int minwidth) const;
 
     int m_socketfd{0};
+    int m_netlinkfd{-1};
+    int m_ifindex{0};
+    uint32_t m_sequence{0U};
+    uint32_t m_pending{0U};
+    uint8_t m_operstate{0U};
+    bool m_carrier{false};
+    bool m_linkchanged{true};
     link_status m_status{};
     string m_interface;
     bool m_tuntap{false};
@@ -117,6 +145,57 @@ namespace net {
     quality_range m_linkquality{};
   };
 
+  // }}}
+  // class : connectivity_probe {{{
+
+  /**
+   * Tests internet connectivity in the background
+   *
+   * An ICMP echo request is sent from an unprivileged datagram socket
+   * every interval, or a TCP connection attempted where such sockets
+   * aren't permitted. Results are cached so reading them never blocks
+   */
+  class connectivity_probe {
+   public:
+    using clock_t = chrono::steady_clock;
+    using duration_t = chrono::duration<double, std::milli>;
+
+    explicit connectivity_probe(const string& host, duration_t interval, duration_t timeout, callback<> on_change);
+    ~connectivity_probe();
+
+    void start();
+    void stop();
+
+    void set_source(const string& ip);
+    bool reachable() const;
+    int latency() const;
+
+   protected:
+    void runner();
+    bool probe(int& latency);
+    bool await_reply(int fd, bool icmp, clock_t::time_point deadline);
+    void wait(duration_t duration);
+
+   private:
+    struct sockaddr_in m_address {};
+    duration_t m_interval;
+    duration_t m_timeout;
+    callback<> m_callback;
+
+    std::mutex m_lock;
+    string m_source;
+
+    int m_wakeupfd{-1};
+    bool m_icmp{true};
+    uint16_t m_sequence{0U};
+
+    atomic<bool> m_reachable{true};
+    atomic<int> m_latency{-1};
+
+    stateflag m_active{false};
+    thread m_thread;
+  };
+
   // }}}
 
   using wireless_t = unique_ptr<wireless_network>;
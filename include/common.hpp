@@ -5,6 +5,7 @@
 #endif
 
 #include <boost/di.hpp>
+#include <boost/utility/string_ref.hpp>
 #include <cstring>
 #include <map>
 #include <memory>
@@ -62,4 +63,6 @@ using std::map;
 using std::vector;
 using std::to_string;
 
+using string_view = boost::string_ref;
+
 POLYBAR_NS_END
@@ -2,6 +2,7 @@
 
 #include "common.hpp"
 #include "components/config.hpp"
+#include "components/parser.hpp"
 #include "components/types.hpp"
 #include "errors.hpp"
 #include "utils/concurrency.hpp"
@@ -19,7 +20,8 @@ class tray_manager;
 class logger;
 class renderer;
 
-class bar : public xpp::event::sink<evt::button_press, evt::expose, evt::property_notify> {
+class bar : public xpp::event::sink<evt::button_press, evt::expose, evt::property_notify,
+                 evt::randr_screen_change_notify> {
  public:
   explicit bar(connection& conn, const config& config, const logger& logger, unique_ptr<screen> screen, unique_ptr<tray_manager> tray_manager);
   ~bar();
@@ -31,9 +33,11 @@ class bar : public xpp::event::sink<evt::button_press, evt::expose, evt::propert
   const bar_settings settings() const;
 
   void parse(const string& data, bool force = false);
+  void parse(const segmentmap_t& segments, bool force = false);
 
  protected:
   void setup_monitor();
+  void reserve_tray_space();
   void configure_geom();
   void restack_window();
   void reconfigure_pos();
@@ -44,6 +48,7 @@ class bar : public xpp::event::sink<evt::button_press, evt::expose, evt::propert
   void handle(const evt::button_press& evt);
   void handle(const evt::expose& evt);
   void handle(const evt::property_notify& evt);
+  void handle(const evt::randr_screen_change_notify& evt);
 
  private:
   connection& m_connection;
@@ -55,8 +60,14 @@ class bar : public xpp::event::sink<evt::button_press, evt::expose, evt::propert
 
   xcb_window_t m_window;
   bar_settings m_opts;
+  parser m_parser{m_log, m_opts};
 
   string m_lastinput;
+  segmentmap_t m_lastsegments;
+
+  drawlist m_compiled;
+  drawlist m_drawlist;
+  map<alignment, vector<drawlist>> m_segmentlists;
 
   std::mutex m_mutex;
 
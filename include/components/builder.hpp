@@ -56,6 +56,7 @@ class builder {
   void underline_close();
   void cmd(mousebtn index, string action, bool condition = true);
   void cmd_close();
+  void graph(unsigned int step, const string& samples);
 
  protected:
   string background_hex();
@@ -29,6 +29,7 @@ class config {
   explicit config(const logger& logger, const xresource_manager& xrm) : m_logger(logger), m_xrm(xrm) {}
 
   void load(string file, string barname);
+  unique_ptr<config> reload() const;
   void copy_inherited();
   string filepath() const;
   string bar_section() const;
@@ -36,6 +37,10 @@ class config {
   string build_path(const string& section, const string& key) const;
   void warn_deprecated(const string& section, const string& key, string replacement) const;
 
+  vector<string> changed_sections(const config& other) const;
+  vector<string> affected_sections(vector<string> changed) const;
+  bool references(const string& section, const string& target) const;
+
   /**
    * Returns true if a given parameter exists
    */
@@ -5,10 +5,10 @@
 #include "common.hpp"
 #include "components/config.hpp"
 #include "components/eventloop.hpp"
+#include "components/executor.hpp"
 #include "components/ipc.hpp"
 #include "components/logger.hpp"
 #include "config.hpp"
-#include "utils/command.hpp"
 #include "utils/inotify.hpp"
 #include "x11/connection.hpp"
 #include "x11/types.hpp"
@@ -52,6 +52,8 @@ class controller {
   void wait_for_configwatch();
 
   void bootstrap_modules();
+  module_t make_module(const bar_settings& bar, const config& conf, const string& module_name);
+  bool reload_config();
 
   void on_ipc_action(const ipc_action& message);
   void on_mouse_event(const string& input);
@@ -93,9 +95,16 @@ class controller {
   map<thread_role, thread> m_threads;
 
   inotify_util::watch_t& m_confwatch;
-  command_util::command_t m_command;
+
+  // Configs loaded on reload, kept alive for the modules built from them
+  vector<unique_ptr<config>> m_configs;
+  map<string, const config*> m_module_configs;
+  vector<string> m_loaded_modules;
+  vector<string> m_disabled_modules;
+  unique_ptr<executor> m_executor;
 
   bool m_writeback{false};
+  bool m_incremental{false};
 };
 
 di::injector<unique_ptr<controller>> configure_controller(watch_t& confwatch);
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <chrono>
+#include <mutex>
+
+#include "common.hpp"
+
+POLYBAR_NS
+
+enum class event_type : uint8_t {
+  NONE = 0,
+  UPDATE,
+  CHECK,
+  INPUT,
+  QUIT,
+  RELOAD,
+};
+
+/**
+ * Priority lanes of the queue. Events in the input
+ * lane (INPUT, QUIT) preempt those in the update lane
+ */
+enum class event_lane : uint8_t {
+  INPUT = 0,
+  UPDATE,
+};
+
+/**
+ * Queue entry
+ *
+ * Kept small so that it can be copied through the queue cheaply.
+ * Payloads that don't fit (input data) are stored out-of-line
+ * in an event_payloads pool and referenced by id
+ */
+struct event {
+  uint8_t type{0};
+  bool flag{false};
+  uint32_t payload{0U};
+};
+
+struct quit_event {
+  bool reload{false};
+};
+
+struct update_event {
+  bool force{false};
+};
+
+struct input_event {
+  string data;
+  std::chrono::steady_clock::time_point time{};
+};
+
+/**
+ * Pool holding event payloads until they are dispatched
+ *
+ * Freed slots are reused, so the pool only grows
+ * to the number of payloads in flight
+ */
+class event_payloads {
+ public:
+  /**
+   * Store payload and get its id
+   */
+  uint32_t store(input_event&& data) {
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    if (m_free.empty()) {
+      m_slots.emplace_back(forward<input_event>(data));
+      return static_cast<uint32_t>(m_slots.size() - 1);
+    }
+
+    uint32_t id{m_free.back()};
+    m_free.pop_back();
+    m_slots[id] = forward<input_event>(data);
+    return id;
+  }
+
+  /**
+   * Remove payload from the pool
+   */
+  input_event take(uint32_t id) {
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    if (id >= m_slots.size()) {
+      return input_event{};
+    }
+
+    input_event data{move(m_slots[id])};
+    m_slots[id].data.clear();
+    m_free.emplace_back(id);
+    return data;
+  }
+
+  /**
+   * Get a copy of the data of a stored payload
+   */
+  string data(uint32_t id) const {
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    if (id >= m_slots.size()) {
+      return string{};
+    }
+
+    return m_slots[id].data;
+  }
+
+  /**
+   * Check if a stored payload carries given data
+   */
+  bool equal(uint32_t id, const string& data) const {
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    if (id >= m_slots.size()) {
+      return false;
+    }
+
+    return m_slots[id].data == data;
+  }
+
+  /**
+   * Drop all payloads
+   */
+  void clear() {
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_slots.clear();
+    m_free.clear();
+  }
+
+  /**
+   * Get the number of payloads in flight
+   */
+  size_t size() const {
+    std::lock_guard<std::mutex> guard(m_lock);
+    return m_slots.size() - m_free.size();
+  }
+
+ private:
+  mutable std::mutex m_lock;
+  vector<input_event> m_slots;
+  vector<uint32_t> m_free;
+};
+
+POLYBAR_NS_END
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <moodycamel/blockingconcurrentqueue.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+
+#include "common.hpp"
+#include "components/event.hpp"
+
+POLYBAR_NS
+
+namespace chrono = std::chrono;
+
+/**
+ * Multi-producer, single-consumer event queue with one lane
+ * per priority. A semaphore counts the events in all lanes,
+ * so the consumer blocks until any of them has one
+ */
+class event_queue {
+ public:
+  using lane_t = moodycamel::ConcurrentQueue<event>;
+  using semaphore_t = moodycamel::details::mpmc_sema::LightweightSemaphore;
+
+  static event_lane lane_of(const event& evt);
+
+  bool enqueue(const event& evt);
+  void dequeue(event& evt);
+  bool dequeue(event& evt, chrono::steady_clock::duration timeout);
+
+  size_t depth(event_lane lane) const;
+  size_t max_depth(event_lane lane) const;
+
+ protected:
+  void take(event& evt);
+
+ private:
+  std::array<lane_t, 2> m_lanes;
+  semaphore_t m_pending;
+
+  std::array<std::atomic<size_t>, 2> m_depth{};
+  std::array<std::atomic<size_t>, 2> m_depth_max{};
+};
+
+POLYBAR_NS_END
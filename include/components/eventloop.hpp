@@ -1,10 +1,12 @@
 #pragma once
 
-#include <moodycamel/blockingconcurrentqueue.h>
 #include <chrono>
 
 #include "common.hpp"
+#include "components/event.hpp"
+#include "components/event_queue.hpp"
 #include "components/logger.hpp"
+#include "components/reactor.hpp"
 #include "modules/meta/base.hpp"
 
 POLYBAR_NS
@@ -12,41 +14,12 @@ POLYBAR_NS
 using module_t = unique_ptr<modules::module_interface>;
 using modulemap_t = map<alignment, vector<module_t>>;
 
-enum class event_type : uint8_t {
-  NONE = 0,
-  UPDATE,
-  CHECK,
-  INPUT,
-  QUIT,
-};
-
-struct event {
-  uint8_t type{0};
-  char data[256]{'\0'};
-};
-
-struct quit_event {
-  const uint8_t type{static_cast<uint8_t>(event_type::QUIT)};
-  bool reload{false};
-};
-
-struct update_event {
-  const uint8_t type{static_cast<uint8_t>(event_type::UPDATE)};
-  bool force{false};
-};
-
-struct input_event {
-  const uint8_t type{static_cast<uint8_t>(event_type::INPUT)};
-  char data[256]{'\0'};
-};
-
 class eventloop {
  public:
   /**
    * Queue type
    */
   using entry_t = event;
-  using queue_t = moodycamel::BlockingConcurrentQueue<entry_t>;
   using duration_t = chrono::duration<double, std::milli>;
 
   explicit eventloop(const logger& logger, const config& config);
@@ -59,56 +32,86 @@ class eventloop {
   bool enqueue(const entry_t& entry);
   bool enqueue_delayed(const entry_t& entry);
 
+  void mark_dirty(const modules::module_interface* module);
+  void batch_updates(bool state);
+
   void set_update_cb(callback<bool>&& cb);
   void set_input_db(callback<string>&& cb);
 
   void add_module(const alignment pos, module_t&& module);
+  void replace_modules(vector<module_t>&& modules, vector<unique_ptr<config>>&& retired = {});
   const modulemap_t& modules() const;
   size_t module_count() const;
 
-  static const eventloop::entry_t& make(update_event&& event, bool force = false) {
+  static eventloop::entry_t make(update_event&& event, bool force = false) {
     event.force = force;
-    return reinterpret_cast<const eventloop::entry_t&>(event);
+    return entry_t{static_cast<uint8_t>(event_type::UPDATE), event.force};
   }
 
-  static const eventloop::entry_t& make(quit_event&& event, bool reload = false) {
+  static eventloop::entry_t make(quit_event&& event, bool reload = false) {
     event.reload = reload;
-    return reinterpret_cast<const eventloop::entry_t&>(event);
+    return entry_t{static_cast<uint8_t>(event_type::QUIT), event.reload};
   }
 
-  static const eventloop::entry_t& make(input_event&& event, const string& data) {
-    snprintf(event.data, sizeof(event.data), "%s", data.c_str());
-    return reinterpret_cast<const eventloop::entry_t&>(event);
+  static eventloop::entry_t make(input_event&& event, const string& data) {
+    event.data = data;
+    event.time = chrono::steady_clock::now();
+    return entry_t{static_cast<uint8_t>(event_type::INPUT), false, s_payloads.store(move(event))};
   }
 
  protected:
+  void dequeue(entry_t& evt);
+  bool dequeue_timed(entry_t& evt, chrono::steady_clock::duration timeout);
+
   void dispatch_modules();
   void dispatch_queue_worker();
   void dispatch_delayed_worker();
 
+  void discard_event(const entry_t& evt);
   inline bool match_event(entry_t evt, event_type type);
-  inline bool compare_events(entry_t evt, entry_t evt2);
+  inline bool compare_delayed(entry_t evt);
   void forward_event(entry_t evt);
 
+  void wait_frame(entry_t& evt);
   void on_update(const update_event& evt);
   void on_input(const input_event& evt);
   void on_check();
   void on_quit(const quit_event& evt);
+  void on_reload();
 
  private:
+  /**
+   * @brief Out-of-line storage for INPUT event data
+   */
+  static event_payloads s_payloads;
+
   const logger& m_log;
   const config& m_conf;
 
   /**
-   * @brief Event queue
+   * @brief Event queue, one lane per priority
    */
-  queue_t m_queue;
+  event_queue m_queue;
 
   /**
    * @brief Loaded modules
    */
   modulemap_t m_modules;
 
+  /**
+   * @brief Rebuilt modules waiting to take the place
+   * of the running modules with the same name, and the
+   * configs to free once the replaced modules are gone
+   */
+  std::mutex m_replace_lock;
+  vector<unique_ptr<config>> m_retired;
+  vector<module_t> m_replacements;
+
+  /**
+   * @brief Shared loop running the modules, if enabled
+   */
+  unique_ptr<reactor> m_reactor;
+
   /**
    * @brief Flag to indicate current run state
    */
@@ -125,14 +128,65 @@ class eventloop {
   callback<string> m_unrecognized_input_cb;
 
   /**
-   * @brief Time to wait for subsequent events
+   * @brief Minimum time between two redraws
+   */
+  duration_t m_frame_interval{0ms};
+
+  /**
+   * @brief Maximum time between receiving an input and
+   * drawing its result, overriding the frame interval
+   */
+  duration_t m_input_latency{0ms};
+
+  /**
+   * @brief Time the last handled input was received
+   */
+  chrono::steady_clock::time_point m_input_time{};
+
+  /**
+   * @brief Input counters, used to report the queueing delay of inputs
+   */
+  size_t m_inputs{0U};
+  size_t m_inputs_late{0U};
+  duration_t m_input_delay_max{0ms};
+
+  /**
+   * @brief Time of the last redraw
+   */
+  chrono::steady_clock::time_point m_frame_time{};
+
+  /**
+   * @brief Lock guarding the dirty set
+   */
+  std::mutex m_dirty_lock;
+
+  /**
+   * @brief Modules that broadcasted new contents since the last redraw
+   */
+  vector<const modules::module_interface*> m_dirty;
+
+  /**
+   * @brief Time of the first broadcast since the last redraw
+   */
+  chrono::steady_clock::time_point m_dirty_time{};
+
+  /**
+   * @brief Flag to indicate that an UPDATE event is waiting in the queue
+   */
+  bool m_update_pending{false};
+
+  /**
+   * @brief Flag to indicate that a batch of module handlers is running
    */
-  duration_t m_swallow_time{0ms};
+  bool m_batching{false};
 
   /**
-   * @brief Maximum amount of subsequent events to swallow within timeframe
+   * @brief Redraw counters, used to report the broadcast to pixels latency
    */
-  size_t m_swallow_limit{0};
+  size_t m_frames{0U};
+  size_t m_broadcasts{0U};
+  duration_t m_latency_total{0ms};
+  duration_t m_latency_max{0ms};
 
   /**
    * @brief Time until releasing the lock on the delayed enqueue channel
@@ -152,7 +206,8 @@ class eventloop {
   /**
    * @brief Pending event on the delayed channel
    */
-  entry_t m_delayed_entry{0};
+  entry_t m_delayed_entry{};
+  string m_delayed_data;
 
   /**
    * @brief Queue worker thread
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <chrono>
+#include <deque>
+#include <mutex>
+
+#include "common.hpp"
+#include "components/logger.hpp"
+#include "errors.hpp"
+#include "utils/command.hpp"
+#include "utils/concurrency.hpp"
+
+POLYBAR_NS
+
+namespace chrono = std::chrono;
+
+/**
+ * Runs shell commands triggered by clicks and ipc actions
+ * in the background
+ *
+ * At most `max_running` commands run at the same time, others
+ * wait in a bounded queue. Finished children are reaped when
+ * SIGCHLD is received on a signalfd, and commands running
+ * longer than their timeout are terminated
+ */
+class executor {
+ public:
+  using clock_t = chrono::steady_clock;
+  using duration_t = chrono::duration<double, std::milli>;
+
+  explicit executor(const logger& logger, size_t max_running, size_t max_pending, duration_t timeout);
+  ~executor();
+
+  void start();
+  void stop();
+
+  bool exec(string cmd);
+
+  // Actions reach the executor as bare commands, without the module
+  // they came from, so the bar only uses the global action-timeout
+  bool exec(string cmd, duration_t timeout);
+
+ protected:
+  struct pending_job {
+    string cmd;
+    duration_t timeout;
+  };
+
+  struct job {
+    string cmd;
+    command_t command;
+    clock_t::time_point deadline;
+    bool output_open{true};
+    bool terminated{false};
+  };
+
+  void dispatch();
+  void spawn_pending();
+  void read_output(job& j);
+  void reap();
+  void expire();
+  int next_timeout() const;
+  void wakeup();
+
+ private:
+  const logger& m_log;
+
+  size_t m_max_running;
+  size_t m_max_pending;
+  duration_t m_timeout;
+
+  int m_signalfd{-1};
+  int m_wakeupfd{-1};
+
+  std::mutex m_lock;
+  std::deque<pending_job> m_pending;
+  vector<unique_ptr<job>> m_running;
+
+  stateflag m_active{false};
+  thread m_thread;
+};
+
+POLYBAR_NS_END
@@ -7,8 +7,10 @@ POLYBAR_NS
 
 class logger;
 struct bar_settings;
+struct drawlist;
 enum class attribute : uint8_t;
 enum class mousebtn : uint8_t;
+enum class drawop_type : uint8_t;
 
 DEFINE_ERROR(parser_error);
 DEFINE_CHILD_ERROR(unrecognized_token, parser_error);
@@ -18,21 +20,26 @@ DEFINE_CHILD_ERROR(unclosed_actionblocks, parser_error);
 class parser {
  public:
   explicit parser(const logger& logger, const bar_settings& bar);
-  void operator()(string data);
-  void codeblock(string data);
-  size_t text(string data);
+  void operator()(string_view data, drawlist& output);
+  void codeblock(string_view data);
+  size_t text(string_view data);
 
  protected:
-  uint32_t parse_color(string s, uint32_t fallback = 0);
-  int8_t parse_fontindex(string s);
+  void emit(drawop_type type, int32_t value = 0);
+
+  uint32_t parse_color(string_view s, uint32_t fallback = 0);
+  int8_t parse_fontindex(string_view s);
+  int32_t parse_integer(string_view s);
   attribute parse_attr(const char attr);
-  mousebtn parse_action_btn(string data);
-  string parse_action_cmd(const string& data);
+  mousebtn parse_action_btn(string_view data);
+  size_t parse_action_cmd(string_view data, string_view& cmd);
+  void parse_samples(string_view data);
 
  private:
   const logger& m_log;
   const bar_settings& m_bar;
   vector<int> m_actions;
+  drawlist* m_output{nullptr};
 };
 
 POLYBAR_NS_END
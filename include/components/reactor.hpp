@@ -0,0 +1,98 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+#include "common.hpp"
+#include "components/logger.hpp"
+#include "utils/concurrency.hpp"
+#include "utils/functional.hpp"
+#include "utils/timer.hpp"
+
+POLYBAR_NS
+
+namespace chrono = std::chrono;
+
+/**
+ * Single threaded epoll loop dispatching file descriptor
+ * and timer callbacks registered by the modules
+ *
+ * Handlers are identified by their owner so that a module
+ * can drop all of its registrations with a single call.
+ * Timers due within the slack window are fired together.
+ * Handlers run without holding the reactor lock, so a slow
+ * handler only delays the handlers dispatched after it
+ */
+class reactor {
+ public:
+  using clock_t = chrono::steady_clock;
+  using duration_t = chrono::duration<double, std::milli>;
+
+  explicit reactor(const logger& logger, duration_t slack = duration_t{0});
+  ~reactor();
+
+  void start();
+  void stop();
+
+  void add_fd(const void* owner, int fd, callback<>&& cb);
+  size_t add_timer(const void* owner, duration_t interval, callback<>&& cb);
+  void remove_timer(size_t id);
+  void remove(const void* owner);
+  void trigger(const void* owner);
+
+  void set_batch_cb(callback<bool>&& cb);
+
+ protected:
+  struct fd_handler {
+    const void* owner;
+    callback<> cb;
+  };
+
+  struct timer_handler {
+    const void* owner;
+    clock_t::duration interval;
+    clock_t::time_point deadline;
+    callback<> cb;
+  };
+
+  /**
+   * Handler due in the current dispatch round
+   */
+  struct pending_call {
+    const void* owner;
+    int fd;
+    size_t timer;
+    callback<> cb;
+  };
+
+  void dispatch();
+  void collect_timers(vector<pending_call>& calls);
+  void invoke(const pending_call& call);
+  int next_timeout() const;
+  uint64_t to_tick(clock_t::time_point tp) const;
+  void wakeup();
+
+ private:
+  const logger& m_log;
+
+  int m_epollfd{-1};
+  int m_wakeupfd{-1};
+
+  std::mutex m_lock;
+  std::condition_variable m_idle;
+  const void* m_inflight{nullptr};
+  map<int, fd_handler> m_handlers;
+  map<size_t, timer_handler> m_timers;
+  size_t m_timerid{0U};
+
+  clock_t::time_point m_epoch;
+  clock_t::duration m_slack;
+  timer_util::timer_wheel m_wheel;
+  callback<bool> m_batch_cb;
+
+  stateflag m_running{false};
+  thread m_thread;
+};
+
+POLYBAR_NS_END
@@ -2,6 +2,7 @@
 
 #include "common.hpp"
 #include "components/types.hpp"
+#include "utils/cache.hpp"
 #include "x11/types.hpp"
 
 POLYBAR_NS
@@ -23,9 +24,18 @@ class renderer {
   void begin();
   void end();
   void flush(bool clear);
+  void invalidate();
+  void invalidate(int16_t x, int16_t y, uint16_t w, uint16_t h);
 
   void reserve_space(edge side, uint16_t w);
 
+  void resize_segments(const alignment align, const size_t count);
+  void begin_segment(const alignment align, const size_t index);
+  void end_segment();
+  void compose_segments();
+
+  void render(const drawlist& list);
+
   void set_background(const uint32_t color);
   void set_foreground(const uint32_t color);
   void set_underline(const uint32_t color);
@@ -41,17 +51,45 @@ class renderer {
   void fill_underline(int16_t x, uint16_t w);
   void fill_shift(const int16_t px);
 
-  void draw_character(const uint16_t character);
-  void draw_textstring(const char* text, const size_t len);
+  void draw_textstring(const uint32_t* text, const size_t len);
+  void draw_graph(const uint8_t* samples, const size_t len, const uint16_t step);
 
   void begin_action(const mousebtn btn, const string& cmd);
   void end_action(const mousebtn btn);
   const vector<action_block> get_actions();
 
  protected:
+  static constexpr size_t MAX_DAMAGE{4U};
+
   int16_t shift_content(int16_t x, const int16_t shift_x);
   int16_t shift_content(const int16_t shift_x);
 
+  void draw_borders();
+  void damage(int16_t x, uint16_t w);
+  void add_span(vector<xcb_rectangle_t>& spans, int16_t x, uint16_t w) const;
+
+  struct segment {
+    xcb_pixmap_t pixmap{XCB_NONE};
+    int16_t x{0};
+    uint16_t width{0U};
+    bool dirty{true};
+    vector<action_block> actions;
+  };
+
+  struct textrun {
+    font_t* font{nullptr};
+    uint32_t offset{0U};
+    uint32_t length{0U};
+    uint16_t width{0U};
+  };
+
+  struct textlayout {
+    vector<textrun> runs;
+    uint16_t width{0U};
+  };
+
+  const textlayout& layout_textstring(const uint32_t* text, const size_t len);
+
 #ifdef DEBUG_HINTS
   vector<xcb_window_t> m_debughints;
   void debug_hints();
@@ -71,9 +109,22 @@ class renderer {
   xcb_visualtype_t* m_visual;
   // xcb_gcontext_t m_gcontext;
   xcb_pixmap_t m_pixmap;
+  xcb_pixmap_t m_canvas{XCB_NONE};
+  xcb_pixmap_t m_scratch{XCB_NONE};
 
   map<gc, xcb_gcontext_t> m_gcontexts;
-  map<alignment, xcb_pixmap_t> m_pixmaps;
+  map<alignment, vector<segment>> m_segments;
+  map<alignment, xcb_rectangle_t> m_extents;
+  segment* m_segment{nullptr};
+  bool m_composed{false};
+
+  // Disjoint spans of the window pixmap changed since the last flush
+  vector<xcb_rectangle_t> m_damage;
+  // Spans flushed since the background was last filled,
+  // covering everything drawn on top of it
+  vector<xcb_rectangle_t> m_drawn;
+  xcb_rectangle_t m_flushed{0, 0, 0U, 0U};
+  bool m_borders_dirty{true};
   vector<action_block> m_actions;
 
   // bool m_autosize{false};
@@ -84,6 +135,12 @@ class renderer {
   int8_t m_fontindex{DEFAULT_FONT_INDEX};
 
   xcb_font_t m_gcfont{XCB_NONE};
+  vector<uint16_t> m_glyphs;
+  vector<xcb_rectangle_t> m_graphbars;
+
+  // Laid out text runs keyed by the preferred font index followed by the text
+  cache_util::lru_cache<std::u32string, textlayout> m_layouts{256};
+  std::u32string m_layoutkey;
 };
 
 di::injector<unique_ptr<renderer>> configure_renderer(const bar_settings& bar, const vector<string>& fonts);
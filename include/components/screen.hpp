@@ -27,6 +27,7 @@ class screen : public xpp::event::sink<evt::randr_screen_change_notify> {
 
  protected:
   void handle(const evt::randr_screen_change_notify& evt);
+  monitor_t find_monitor(const vector<monitor_t>& monitors) const;
 
  private:
   connection& m_connection;
@@ -37,6 +38,7 @@ class screen : public xpp::event::sink<evt::randr_screen_change_notify> {
   xcb_window_t m_proxy{XCB_NONE};
 
   vector<monitor_t> m_monitors;
+  monitor_t m_monitor;
   struct size m_size{0U, 0U};
   bool m_sigraised{false};
 };
@@ -22,6 +22,7 @@ enum class syntaxtag : uint8_t {
   R,  // flip colors
   o,  // overline color
   u,  // underline color
+  G,  // graph
 };
 
 enum class mousebtn : uint8_t { NONE = 0U, LEFT, MIDDLE, RIGHT, SCROLL_UP, SCROLL_DOWN };
@@ -134,6 +135,66 @@ struct action_block {
   }
 };
 
+using segmentmap_t = map<alignment, vector<string>>;
+
+enum class drawop_type : uint8_t {
+  NONE = 0U,
+  BACKGROUND,
+  FOREGROUND,
+  UNDERLINE,
+  OVERLINE,
+  FONT,
+  OFFSET,
+  ALIGNMENT,
+  ATTRIBUTE_SET,
+  ATTRIBUTE_UNSET,
+  ATTRIBUTE_TOGGLE,
+  ACTION_OPEN,
+  ACTION_CLOSE,
+  TEXT,
+  GRAPH,
+};
+
+/**
+ * Single draw operation produced by the parser
+ *
+ * Depending on the type, `value` holds a color, font index,
+ * pixel offset, alignment, attribute or mouse button. Text runs and
+ * action commands reference a slice of the draw list's buffers.
+ */
+struct drawop {
+  drawop_type type{drawop_type::NONE};
+  int32_t value{0};
+  uint32_t offset{0U};
+  uint32_t length{0U};
+
+  bool operator==(const drawop& other) const {
+    return type == other.type && value == other.value && offset == other.offset && length == other.length;
+  }
+};
+
+struct drawlist {
+  vector<drawop> ops;
+  vector<uint32_t> text;
+  vector<uint8_t> samples;
+  string commands;
+
+  void clear() {
+    ops.clear();
+    text.clear();
+    samples.clear();
+    commands.clear();
+  }
+
+  bool operator==(const drawlist& other) const {
+    return ops == other.ops && text == other.text && samples == other.samples && commands == other.commands;
+  }
+
+  bool operator!=(const drawlist& other) const {
+    return !(*this == other);
+  }
+};
+
 struct event_timer {
   xcb_timestamp_t event{0L};
   xcb_timestamp_t offset{1L};
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "common.hpp"
+#include "components/builder.hpp"
+#include "components/config.hpp"
+#include "components/types.hpp"
+#include "utils/history.hpp"
+#include "utils/mixins.hpp"
+
+POLYBAR_NS
+
+namespace drawtypes {
+  /**
+   * Sparkline of the most recent samples
+   *
+   * The samples are emitted as a single graph tag which
+   * the renderer draws as one bar per sample
+   */
+  class graph : public non_copyable_mixin<graph> {
+   public:
+    explicit graph(const bar_settings& bar, size_t samples, unsigned int step, float max);
+
+    void set_foreground(string color);
+
+    void add(float value);
+    string output();
+
+   private:
+    unique_ptr<builder> m_builder;
+    history_util::ring_buffer<float> m_samples;
+    unsigned int m_step;
+    float m_max;
+    string m_foreground;
+  };
+
+  using graph_t = shared_ptr<graph>;
+
+  graph_t load_graph(const bar_settings& bar, const config& conf, const string& section, string name, float max = 0.0f);
+}
+
+POLYBAR_NS_END
@@ -40,6 +40,7 @@ namespace modules {
     int current_percentage();
     battery_state current_state();
     string current_time();
+    void poll_values();
     void subthread();
 
    private:
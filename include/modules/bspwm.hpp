@@ -42,6 +42,7 @@ namespace modules {
     void stop();
     bool has_event();
     bool update();
+    int get_file_descriptor() const;
     string get_output();
     bool build(builder* builder, const string& tag) const;
     bool handle_event(string cmd);
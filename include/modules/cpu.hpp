@@ -1,23 +1,11 @@
 #pragma once
 
-#include <istream>
-
-#include "config.hpp"
 #include "modules/meta/timer_module.hpp"
+#include "utils/proc.hpp"
 
 POLYBAR_NS
 
 namespace modules {
-  struct cpu_time {
-    unsigned long long user;
-    unsigned long long nice;
-    unsigned long long system;
-    unsigned long long idle;
-    unsigned long long total;
-  };
-
-  using cpu_time_t = unique_ptr<cpu_time>;
-
   class cpu_module : public timer_module<cpu_module> {
    public:
     using timer_module::timer_module;
@@ -33,16 +21,19 @@ namespace modules {
    private:
     static constexpr auto TAG_LABEL = "<label>";
     static constexpr auto TAG_BAR_LOAD = "<bar-load>";
+    static constexpr auto TAG_GRAPH_LOAD = "<graph-load>";
     static constexpr auto TAG_RAMP_LOAD = "<ramp-load>";
     static constexpr auto TAG_RAMP_LOAD_PER_CORE = "<ramp-coreload>";
 
     progressbar_t m_barload;
+    graph_t m_graphload;
     ramp_t m_rampload;
     ramp_t m_rampload_core;
     label_t m_label;
 
-    vector<cpu_time_t> m_cputimes;
-    vector<cpu_time_t> m_cputimes_prev;
+    shared_ptr<proc_util::sampler> m_sampler;
+    proc_util::cpu_snapshot_t m_cputimes;
+    proc_util::cpu_snapshot_t m_cputimes_prev;
 
     float m_total = 0;
     vector<float> m_load;
@@ -3,6 +3,7 @@
 #include "components/config.hpp"
 #include "config.hpp"
 #include "modules/meta/timer_module.hpp"
+#include "utils/mtab.hpp"
 
 POLYBAR_NS
 
@@ -62,6 +63,7 @@ namespace modules {
 
     vector<string> m_mountpoints;
     vector<fs_mount_t> m_mounts;
+    mtab_util::mountinfo m_mountinfo;
     bool m_fixed = false;
     int m_spacing = 2;
 
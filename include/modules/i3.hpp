@@ -36,6 +36,7 @@ namespace modules {
 
     void setup();
     void stop();
+    int get_file_descriptor() const;
     bool has_event();
     bool update();
     bool build(builder* builder, const string& tag) const;
@@ -1,9 +1,7 @@
 #pragma once
 
-#include <istream>
-
-#include "config.hpp"
 #include "modules/meta/timer_module.hpp"
+#include "utils/proc.hpp"
 
 POLYBAR_NS
 
@@ -22,10 +20,14 @@ namespace modules {
     static constexpr auto TAG_LABEL = "<label>";
     static constexpr auto TAG_BAR_USED = "<bar-used>";
     static constexpr auto TAG_BAR_FREE = "<bar-free>";
+    static constexpr auto TAG_GRAPH_USED = "<graph-used>";
+
+    shared_ptr<proc_util::sampler> m_sampler;
 
     label_t m_label;
     progressbar_t m_bar_free;
     map<memtype, progressbar_t> m_bars;
+    graph_t m_graph_used;
     map<memtype, int> m_perc;
   };
 }
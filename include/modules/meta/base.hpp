@@ -35,6 +35,8 @@ namespace drawtypes {
   using ramp_t = shared_ptr<ramp>;
   class progressbar;
   using progressbar_t = shared_ptr<progressbar>;
+  class graph;
+  using graph_t = shared_ptr<graph>;
   class animation;
   using animation_t = shared_ptr<animation>;
   using icon = label;
@@ -44,6 +46,7 @@ namespace drawtypes {
 }
 
 class builder;
+class reactor;
 
 // }}}
 
@@ -113,6 +116,7 @@ namespace modules {
 
     virtual void set_update_cb(callback<>&& cb) = 0;
     virtual void set_stop_cb(callback<>&& cb) = 0;
+    virtual void set_reactor(reactor* reactor) = 0;
   };
 
   // }}}
@@ -126,6 +130,7 @@ namespace modules {
 
     void set_update_cb(callback<>&& cb);
     void set_stop_cb(callback<>&& cb);
+    void set_reactor(reactor* reactor);
 
     string name() const;
     bool running() const;
@@ -149,6 +154,9 @@ namespace modules {
     callback<> m_update_callback;
     callback<> m_stop_callback;
 
+    // Shared event loop used instead of a module thread when set
+    reactor* m_reactor{nullptr};
+
     concurrency_util::spin_lock m_lock;
 
     const bar_settings m_bar;
@@ -1,4 +1,5 @@
 #include "components/builder.hpp"
+#include "components/reactor.hpp"
 
 POLYBAR_NS
 
@@ -35,6 +36,11 @@ namespace modules {
     m_stop_callback = forward<decltype(cb)>(cb);
   }
 
+  template <typename Impl>
+  void module<Impl>::set_reactor(reactor* reactor) {
+    m_reactor = reactor;
+  }
+
   template <typename Impl>
   string module<Impl>::name() const {
     return m_name;
@@ -68,6 +74,10 @@ namespace modules {
 
     wakeup();
 
+    if (m_reactor) {
+      m_reactor->remove(this);
+    }
+
     std::lock_guard<concurrency_util::spin_lock> guard(m_lock);
     {
       CAST_MOD(Impl)->teardown();
@@ -139,6 +149,10 @@ namespace modules {
   void module<Impl>::wakeup() {
     m_log.trace("%s: Release sleep lock", name());
     m_sleephandler.notify_all();
+
+    if (m_reactor) {
+      m_reactor->trigger(this);
+    }
   }
 
   template <typename Impl>
@@ -15,8 +15,16 @@ namespace modules {
 
     void start();
 
+    int get_file_descriptor() const;
+    vector<int> get_file_descriptors() const;
+
    protected:
     void runner();
+    void on_readable();
+    void watch(vector<int>&& fds);
+
+   private:
+    vector<int> m_fds;
   };
 }
 
@@ -5,7 +5,46 @@ namespace modules {
 
   template <class Impl>
   void event_module<Impl>::start() {
-    CAST_MOD(Impl)->m_mainthread = thread(&event_module::runner, this);
+    vector<int> fds;
+
+    if (!this->m_reactor || (fds = CONST_MOD(Impl).get_file_descriptors()).empty()) {
+      CAST_MOD(Impl)->m_mainthread = thread(&event_module::runner, this);
+      return;
+    } else if (!CONST_MOD(Impl).running()) {
+      return;
+    }
+
+    try {
+      std::lock_guard<concurrency_util::spin_lock> guard(this->m_lock);
+      {
+        CAST_MOD(Impl)->update();
+        CAST_MOD(Impl)->broadcast();
+      }
+      watch(move(fds));
+    } catch (const module_error& err) {
+      CAST_MOD(Impl)->halt(err.what());
+    } catch (const std::exception& err) {
+      CAST_MOD(Impl)->halt(err.what());
+    }
+  }
+
+  /**
+   * Get the descriptor signaling new events, used in reactor mode.
+   * Modules without one get their own thread
+   */
+  template <class Impl>
+  int event_module<Impl>::get_file_descriptor() const {
+    return -1;
+  }
+
+  /**
+   * Get all descriptors signaling new events, for modules
+   * listening on more than one source
+   */
+  template <class Impl>
+  vector<int> event_module<Impl>::get_file_descriptors() const {
+    int fd{CONST_MOD(Impl).get_file_descriptor()};
+    return fd != -1 ? vector<int>{fd} : vector<int>{};
   }
 
   // }}}
@@ -45,6 +84,38 @@ namespace modules {
     }
   }
 
+  template <class Impl>
+  void event_module<Impl>::on_readable() {
+    try {
+      std::lock_guard<concurrency_util::spin_lock> guard(this->m_lock);
+      {
+        if (CONST_MOD(Impl).running() && CAST_MOD(Impl)->has_event() && CAST_MOD(Impl)->update())
+          CAST_MOD(Impl)->broadcast();
+
+        // Follow the new descriptors if the module reconnected
+        auto fds = CONST_MOD(Impl).get_file_descriptors();
+
+        if (fds != m_fds && CONST_MOD(Impl).running()) {
+          this->m_reactor->remove(this);
+          watch(move(fds));
+        }
+      }
+    } catch (const module_error& err) {
+      CAST_MOD(Impl)->halt(err.what());
+    } catch (const std::exception& err) {
+      CAST_MOD(Impl)->halt(err.what());
+    }
+  }
+
+  template <class Impl>
+  void event_module<Impl>::watch(vector<int>&& fds) {
+    m_fds = forward<decltype(fds)>(fds);
+
+    for (auto&& fd : m_fds) {
+      this->m_reactor->add_fd(this, fd, bind(&event_module::on_readable, this));
+    }
+  }
+
   // }}}
 }
 
@@ -18,9 +18,15 @@ namespace modules {
     void watch(string path, int mask = IN_ALL_EVENTS);
     void idle();
     void poll_events();
+    void on_readable(inotify_util::inotify_watch* watch);
+    void on_retry();
+    bool attach_watches();
+    void discard_events();
 
    private:
     map<string, int> m_watchlist;
+    vector<inotify_util::watch_t> m_watches;
+    size_t m_retry{0U};
   };
 }
 
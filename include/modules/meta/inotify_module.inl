@@ -5,7 +5,41 @@ namespace modules {
 
   template <class Impl>
   void inotify_module<Impl>::start() {
-    CAST_MOD(Impl)->m_mainthread = thread(&inotify_module::runner, this);
+    if (!this->m_reactor) {
+      CAST_MOD(Impl)->m_mainthread = thread(&inotify_module::runner, this);
+      return;
+    } else if (!CONST_MOD(Impl).running()) {
+      return;
+    }
+
+    try {
+      {
+        std::lock_guard<concurrency_util::spin_lock> guard(this->m_lock);
+        CAST_MOD(Impl)->on_event(nullptr);
+        CAST_MOD(Impl)->broadcast();
+      }
+
+      // Keep the inotify descriptors open for the lifetime of the module
+      // and let the reactor wait on them. The watches are attached after
+      // the initial read so that it doesn't queue any events
+      for (auto&& w : m_watchlist) {
+        m_watches.emplace_back(inotify_util::make_watch(w.first));
+        m_watches.back()->attach(w.second);
+      }
+
+      for (auto&& w : m_watches) {
+        this->m_reactor->add_fd(this, w->get_file_descriptor(), bind(&inotify_module::on_readable, this, w.get()));
+      }
+    } catch (const system_error& e) {
+      this->m_log.err("%s: Error while creating inotify watch (what: %s)", CONST_MOD(Impl).name(), e.what());
+      this->m_reactor->remove(this);
+      m_watches.clear();
+      CAST_MOD(Impl)->m_mainthread = thread(&inotify_module::runner, this);
+    } catch (const module_error& err) {
+      CAST_MOD(Impl)->halt(err.what());
+    } catch (const std::exception& err) {
+      CAST_MOD(Impl)->halt(err.what());
+    }
   }
 
   // }}}
@@ -90,6 +124,100 @@ namespace modules {
     }
   }
 
+  template <class Impl>
+  void inotify_module<Impl>::on_readable(inotify_util::inotify_watch* watch) {
+    try {
+      std::lock_guard<concurrency_util::spin_lock> guard(this->m_lock);
+      {
+        auto event = watch->get_event();
+
+        // Detach the watches while the module reads the watched
+        // files, otherwise its own reads would queue new events
+        for (auto&& w : m_watches) {
+          w->remove(true);
+        }
+
+        if (CONST_MOD(Impl).running() && CAST_MOD(Impl)->on_event(event.get()))
+          CAST_MOD(Impl)->broadcast();
+
+        if (attach_watches()) {
+          // Discard the IN_IGNORED events queued by the removal
+          discard_events();
+        } else if (CONST_MOD(Impl).running()) {
+          // The file may be in the middle of being replaced, try again shortly
+          m_retry = this->m_reactor->add_timer(this, reactor::duration_t{100}, bind(&inotify_module::on_retry, this));
+        }
+      }
+    } catch (const module_error& err) {
+      CAST_MOD(Impl)->halt(err.what());
+    } catch (const std::exception& err) {
+      CAST_MOD(Impl)->halt(err.what());
+    }
+  }
+
+  /**
+   * Attach the watches again after attaching failed
+   */
+  template <class Impl>
+  void inotify_module<Impl>::on_retry() {
+    try {
+      std::lock_guard<concurrency_util::spin_lock> guard(this->m_lock);
+      {
+        if (!CONST_MOD(Impl).running() || !attach_watches()) {
+          return;
+        }
+
+        this->m_reactor->remove_timer(m_retry);
+
+        // Values may have changed while nothing was watched
+        if (CAST_MOD(Impl)->on_event(nullptr))
+          CAST_MOD(Impl)->broadcast();
+
+        discard_events();
+      }
+    } catch (const module_error& err) {
+      CAST_MOD(Impl)->halt(err.what());
+    } catch (const std::exception& err) {
+      CAST_MOD(Impl)->halt(err.what());
+    }
+  }
+
+  /**
+   * Attach all watches
+   *
+   * If one of them fails, the others are detached again so
+   * that none of the descriptors becomes readable until retried
+   */
+  template <class Impl>
+  bool inotify_module<Impl>::attach_watches() {
+    try {
+      auto w = m_watches.begin();
+      for (auto&& entry : m_watchlist) {
+        (*w++)->attach(entry.second);
+      }
+      return true;
+    } catch (const system_error& e) {
+      this->m_log.err("%s: Error while attaching inotify watch (what: %s)", CONST_MOD(Impl).name(), e.what());
+    }
+
+    for (auto&& w : m_watches) {
+      w->remove(true);
+    }
+
+    discard_events();
+    return false;
+  }
+
+  /**
+   * Drop events pending on the watch descriptors
+   */
+  template <class Impl>
+  void inotify_module<Impl>::discard_events() {
+    for (auto&& w : m_watches) {
+      w->drain();
+    }
+  }
+
   // }}}
 }
 
@@ -22,6 +22,7 @@ namespace modules {
     interval_t m_interval{1};
 
     void runner();
+    void tick();
   };
 }
 
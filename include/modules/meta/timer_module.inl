@@ -5,7 +5,11 @@ namespace modules {
 
   template <typename Impl>
   void timer_module<Impl>::start() {
-    CAST_MOD(Impl)->m_mainthread = thread(&timer_module::runner, this);
+    if (this->m_reactor && CONST_MOD(Impl).running()) {
+      this->m_reactor->add_timer(this, m_interval, bind(&timer_module::tick, this));
+    } else if (!this->m_reactor) {
+      CAST_MOD(Impl)->m_mainthread = thread(&timer_module::runner, this);
+    }
   }
 
   // }}}
@@ -29,6 +33,21 @@ namespace modules {
     }
   }
 
+  template <typename Impl>
+  void timer_module<Impl>::tick() {
+    try {
+      std::lock_guard<concurrency_util::spin_lock> guard(this->m_lock);
+      {
+        if (CONST_MOD(Impl).running() && CAST_MOD(Impl)->update())
+          CAST_MOD(Impl)->broadcast();
+      }
+    } catch (const module_error& err) {
+      CAST_MOD(Impl)->halt(err.what());
+    } catch (const std::exception& err) {
+      CAST_MOD(Impl)->halt(err.what());
+    }
+  }
+
   // }}}
 }
 
@@ -14,12 +14,18 @@ namespace modules {
     using timer_module::timer_module;
 
     void setup();
+    void start();
+    void stop();
     void teardown();
     bool update();
     string get_format() const;
     bool build(builder* builder, const string& tag) const;
 
    protected:
+    void refresh();
+    void on_link_event();
+    void on_probe_change();
+    net::network* get_network() const;
     void subthread_routine();
 
    private:
@@ -28,6 +34,8 @@ namespace modules {
     static constexpr auto FORMAT_DISCONNECTED = "format-disconnected";
     static constexpr auto TAG_RAMP_SIGNAL = "<ramp-signal>";
     static constexpr auto TAG_RAMP_QUALITY = "<ramp-quality>";
+    static constexpr auto TAG_GRAPH_DOWNSPEED = "<graph-downspeed>";
+    static constexpr auto TAG_GRAPH_UPSPEED = "<graph-upspeed>";
     static constexpr auto TAG_LABEL_CONNECTED = "<label-connected>";
     static constexpr auto TAG_LABEL_DISCONNECTED = "<label-disconnected>";
     static constexpr auto TAG_LABEL_PACKETLOSS = "<label-packetloss>";
@@ -35,9 +43,12 @@ namespace modules {
 
     net::wired_t m_wired;
     net::wireless_t m_wireless;
+    unique_ptr<net::connectivity_probe> m_probe;
 
     ramp_t m_ramp_signal;
     ramp_t m_ramp_quality;
+    graph_t m_graph_downspeed;
+    graph_t m_graph_upspeed;
     animation_t m_animation_packetloss;
     map<connection_state, label_t> m_label;
 
@@ -46,12 +57,13 @@ namespace modules {
 
     int m_signal{0};
     int m_quality{0};
-    int m_counter{-1};  // -1 to ignore the first run
 
     string m_interface;
     int m_ping_nth_update{0};
+    float m_ping_timeout{2.0f};
     int m_udspeed_minwidth{0};
     bool m_accumulate{false};
+    bool m_polling{true};
   };
 }
 
@@ -31,9 +31,12 @@ namespace modules {
     static constexpr const char* TAG_LABEL{"<label>"};
 
     command_util::command_t m_command;
+    unique_ptr<command_util::worker> m_worker;
 
     string m_exec;
     bool m_tail{false};
+    bool m_persistent{false};
+    bool m_latest{false};
     chrono::duration<double> m_interval{0};
     map<mousebtn, string> m_actions;
 
@@ -41,6 +44,7 @@ namespace modules {
     string m_output;
     string m_prev;
     int m_counter{0};
+    size_t m_dropped{0U};
 
     // @deprecated
     size_t m_maxlen{0};
@@ -48,6 +48,7 @@ namespace modules {
     }                                                                                   \
     void set_update_cb(callback<>&&) {}                                                 \
     void set_stop_cb(callback<>&&) {}                                                   \
+    void set_reactor(reactor*) {}                                                       \
   }
 
 #if not ENABLE_I3
@@ -20,6 +20,7 @@ namespace modules {
 
     void setup();
     void teardown();
+    vector<int> get_file_descriptors() const;
     bool has_event();
     bool update();
     string get_format() const;
@@ -19,7 +19,7 @@ namespace modules {
     explicit active_window(xcb_window_t win);
     ~active_window();
     bool match(const xcb_window_t win) const;
-    string title(xcb_ewmh_connection_t* ewmh) const;
+    string title() const;
 
    private:
     connection& m_connection;
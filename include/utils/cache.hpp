@@ -0,0 +1,109 @@
+#pragma once
+
+#include <list>
+#include <unordered_map>
+
+#include "common.hpp"
+
+POLYBAR_NS
+
+namespace cache_util {
+  /**
+   * Fixed size key/value cache evicting the least recently used entry
+   *
+   * Example usage:
+   * @code cpp
+   *   cache_util::lru_cache<string, int> cache{64};
+   *   if (cache.find("key") == nullptr)
+   *     cache.insert("key", 1);
+   * @endcode
+   */
+  template <typename Key, typename Value, typename Hash = std::hash<Key>>
+  class lru_cache {
+   public:
+    using entry_t = std::pair<Key, Value>;
+    using list_t = std::list<entry_t>;
+
+    /**
+     * Construct cache holding at most `capacity` entries
+     */
+    explicit lru_cache(size_t capacity) : m_capacity(capacity) {
+      m_index.reserve(capacity);
+    }
+
+    /**
+     * Get the value stored for key and mark it as most recently used,
+     * or nullptr if the key is not cached
+     */
+    Value* find(const Key& key) {
+      auto it = m_index.find(key);
+      if (it == m_index.end()) {
+        m_misses++;
+        return nullptr;
+      }
+      m_hits++;
+      m_entries.splice(m_entries.begin(), m_entries, it->second);
+      return &it->second->second;
+    }
+
+    /**
+     * Store value for key, evicting the least recently used
+     * entry when the cache is full
+     */
+    Value& insert(const Key& key, Value value) {
+      auto it = m_index.find(key);
+      if (it != m_index.end()) {
+        it->second->second = move(value);
+        m_entries.splice(m_entries.begin(), m_entries, it->second);
+        return it->second->second;
+      }
+
+      if (m_entries.size() >= m_capacity && !m_entries.empty()) {
+        // Reuse the evicted node to avoid reallocating it
+        auto last = std::prev(m_entries.end());
+        m_index.erase(last->first);
+        last->first = key;
+        last->second = move(value);
+        m_entries.splice(m_entries.begin(), m_entries, last);
+      } else {
+        m_entries.emplace_front(key, move(value));
+      }
+
+      m_index.emplace(m_entries.front().first, m_entries.begin());
+      return m_entries.front().second;
+    }
+
+    /**
+     * Remove all entries
+     */
+    void clear() {
+      m_index.clear();
+      m_entries.clear();
+    }
+
+    size_t size() const {
+      return m_entries.size();
+    }
+
+    size_t capacity() const {
+      return m_capacity;
+    }
+
+    size_t hits() const {
+      return m_hits;
+    }
+
+    size_t misses() const {
+      return m_misses;
+    }
+
+   private:
+    size_t m_capacity;
+    size_t m_hits{0U};
+    size_t m_misses{0U};
+    list_t m_entries;
+    std::unordered_map<Key, typename list_t::iterator, Hash> m_index;
+  };
+}
+
+POLYBAR_NS_END
@@ -4,6 +4,7 @@
 #include "components/logger.hpp"
 #include "utils/concurrency.hpp"
 #include "utils/functional.hpp"
+#include "utils/io.hpp"
 
 POLYBAR_NS
 
@@ -53,6 +54,8 @@ namespace command_util {
     void tail(callback<string> cb);
     int writeline(string data);
     string readline();
+    bool readline(string& line);
+    bool try_readline(string& line);
 
     int get_stdout(int c);
     int get_stdin(int c);
@@ -67,6 +70,8 @@ namespace command_util {
     int m_stdout[2];
     int m_stdin[2];
 
+    unique_ptr<io_util::line_reader> m_reader;
+
     pid_t m_forkpid;
     int m_forkstatus;
 
@@ -79,9 +84,44 @@ namespace command_util {
   command_t make_command(Args&&... args) {
     return make_unique<command>(configure_logger().create<const logger&>(), forward<Args>(args)...);
   }
+
+  /**
+   * Long-lived shell running the commands written to its input
+   *
+   * Used to poll a command without spawning a new process tree
+   * every time. Each command runs in a subshell with stdin closed,
+   * and is followed by a marker line carrying its exit status
+   *
+   * Example usage:
+   * @code cpp
+   *   command_util::worker worker{logger};
+   *   vector<string> output;
+   *   worker.run("date +%s", output);
+   * @endcode
+   */
+  class worker {
+   public:
+    explicit worker(const logger& logger);
+
+    int run(const string& cmd, vector<string>& output);
+    bool is_running();
+    void terminate();
+    void kill();
+
+   protected:
+    void start();
+
+   private:
+    const logger& m_log;
+    std::mutex m_lock;
+    command_t m_shell;
+    string m_marker;
+    std::atomic_bool m_killed{false};
+  };
 }
 
 using command = command_util::command;
 using command_t = command_util::command_t;
+using worker = command_util::worker;
 
 POLYBAR_NS_END
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "common.hpp"
+
+POLYBAR_NS
+
+namespace history_util {
+  /**
+   * Fixed size buffer keeping the most recent samples
+   *
+   * Storage is allocated once, pushing into a full buffer
+   * overwrites the oldest sample
+   *
+   * Example usage:
+   * @code cpp
+   *   history_util::ring_buffer<float> history{3};
+   *   history.push(1.0f);
+   *   history[0]; // oldest sample
+   * @endcode
+   */
+  template <typename T>
+  class ring_buffer {
+   public:
+    explicit ring_buffer(size_t capacity) : m_samples(capacity) {}
+
+    /**
+     * Append sample, dropping the oldest one when full
+     */
+    void push(T sample) {
+      if (m_samples.empty()) {
+        return;
+      }
+
+      m_samples[m_head] = move(sample);
+      m_head = (m_head + 1) % m_samples.size();
+
+      if (m_size < m_samples.size()) {
+        m_size++;
+      }
+    }
+
+    /**
+     * Get sample by age, index 0 being the oldest
+     */
+    const T& operator[](size_t index) const {
+      return m_samples[(m_head + m_samples.size() - m_size + index) % m_samples.size()];
+    }
+
+    /**
+     * Get the most recent sample
+     */
+    const T& back() const {
+      return (*this)[m_size - 1];
+    }
+
+    /**
+     * Remove all samples
+     */
+    void clear() {
+      m_head = 0;
+      m_size = 0;
+    }
+
+    size_t size() const {
+      return m_size;
+    }
+
+    size_t capacity() const {
+      return m_samples.size();
+    }
+
+    bool empty() const {
+      return m_size == 0;
+    }
+
+    bool full() const {
+      return m_size == m_samples.size();
+    }
+
+   private:
+    vector<T> m_samples;
+    size_t m_head{0};
+    size_t m_size{0};
+  };
+}
+
+POLYBAR_NS_END
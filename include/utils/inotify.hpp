@@ -28,8 +28,10 @@ namespace inotify_util {
     void remove(bool force = false);
     bool poll(int wait_ms = 1000);
     unique_ptr<event_t> get_event();
+    void drain();
     bool await_match();
     const string path() const;
+    int get_file_descriptor() const;
 
    protected:
     string m_path;
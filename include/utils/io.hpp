@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdio>
+
 #include "common.hpp"
 
 POLYBAR_NS
@@ -21,6 +23,38 @@ namespace io_util {
   bool poll_write(int fd, int timeout_ms = 1);
 
   bool interrupt_read(int write_fd);
+
+  /**
+   * Buffered line reader
+   *
+   * Data is read from the descriptor in chunks into a ring buffer
+   * and split on newlines, instead of issuing one read per byte.
+   * The buffer grows when a single line doesn't fit
+   */
+  class line_reader {
+   public:
+    explicit line_reader(int fd, size_t capacity = BUFSIZ);
+
+    bool readline(string& line);
+    bool try_readline(string& line);
+
+    bool eof() const;
+    size_t buffered() const;
+    int get_fd() const;
+
+   protected:
+    bool extract(string& line);
+    bool extract_remainder(string& line);
+    bool fill();
+    void grow();
+
+   private:
+    int m_fd;
+    vector<char> m_buffer;
+    size_t m_head{0U};
+    size_t m_size{0U};
+    bool m_eof{false};
+  };
 }
 
 POLYBAR_NS_END
@@ -1,35 +1,48 @@
 #pragma once
 
-#include <mntent.h>
+#include <unordered_map>
 
 #include "common.hpp"
+#include "utils/proc.hpp"
 
 POLYBAR_NS
 
 namespace mtab_util {
   /**
-   * Wrapper for reading mtab entries
+   * Mount table entry
    */
-  class reader {
+  struct mount_entry {
+    string type;
+    string fsname;
+  };
+
+  using mount_index = std::unordered_map<string, mount_entry>;
+
+  bool parse_mountinfo(const char* data, size_t size, mount_index& mounts);
+
+  /**
+   * Index of /proc/self/mountinfo by mountpoint
+   *
+   * The kernel flags the open file with POLLPRI whenever the mount
+   * table changes, so the file is only parsed again after a change
+   */
+  class mountinfo {
    public:
-    explicit reader() {
-      if ((m_ptr = setmntent("/etc/mtab", "r")) == nullptr) {
-        throw system_error("Failed to read mtab");
-      }
-    }
-
-    ~reader() {
-      if (m_ptr != nullptr) {
-        endmntent(m_ptr);
-      }
-    }
-
-    bool next(mntent** dst) {
-      return (*dst = getmntent(m_ptr)) != nullptr;
-    }
+    explicit mountinfo(string path = "/proc/self/mountinfo");
+
+    bool update();
+    const mount_entry* find(const string& mountpoint) const;
+
+    size_t reads() const;
 
    protected:
-    FILE* m_ptr = nullptr;
+    bool changed() const;
+    void read();
+
+   private:
+    proc_util::proc_file m_file;
+    mount_index m_mounts;
+    size_t m_reads{0U};
   };
 }
 
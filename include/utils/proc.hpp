@@ -0,0 +1,99 @@
+#pragma once
+
+#include <chrono>
+#include <mutex>
+
+#include "common.hpp"
+
+POLYBAR_NS
+
+namespace chrono = std::chrono;
+
+namespace proc_util {
+  struct cpu_time {
+    unsigned long long user{0ULL};
+    unsigned long long nice{0ULL};
+    unsigned long long system{0ULL};
+    unsigned long long idle{0ULL};
+    unsigned long long total{0ULL};
+  };
+
+  /**
+   * Per core times read from /proc/stat
+   */
+  struct cpu_snapshot {
+    vector<cpu_time> cores;
+    chrono::steady_clock::time_point time{};
+  };
+
+  /**
+   * Memory values read from /proc/meminfo, in kB
+   */
+  struct memory_snapshot {
+    unsigned long long total{0ULL};
+    unsigned long long free{0ULL};
+    unsigned long long available{0ULL};
+    chrono::steady_clock::time_point time{};
+  };
+
+  using cpu_snapshot_t = shared_ptr<const cpu_snapshot>;
+  using memory_snapshot_t = shared_ptr<const memory_snapshot>;
+
+  bool parse_stat(const char* data, size_t size, vector<cpu_time>& cores);
+  bool parse_meminfo(const char* data, size_t size, memory_snapshot& memory);
+
+  /**
+   * File kept open and read from the start
+   */
+  class proc_file {
+   public:
+    explicit proc_file(string path, size_t capacity = 4096);
+    ~proc_file();
+
+    size_t read();
+    size_t read_all();
+    void grow();
+    const char* data() const;
+    size_t capacity() const;
+    int get_file_descriptor() const;
+
+   protected:
+    void open();
+
+   private:
+    string m_path;
+    int m_fd{-1};
+    vector<char> m_buffer;
+  };
+
+  /**
+   * Reads /proc/stat and /proc/meminfo on behalf of all modules
+   *
+   * Every read publishes a new immutable snapshot. Modules asking
+   * for values within `max_age` of the last read share the same
+   * snapshot instead of reading the files again
+   */
+  class sampler {
+   public:
+    using duration_t = chrono::duration<double, std::milli>;
+
+    explicit sampler(string stat_path, string meminfo_path);
+
+    cpu_snapshot_t cpu(duration_t max_age = duration_t{100});
+    memory_snapshot_t memory(duration_t max_age = duration_t{100});
+
+    size_t reads() const;
+
+   private:
+    std::mutex m_lock;
+    proc_file m_stat;
+    proc_file m_meminfo;
+    shared_ptr<cpu_snapshot> m_cpu;
+    shared_ptr<memory_snapshot> m_memory;
+    size_t m_reads{0U};
+  };
+
+  shared_ptr<sampler> make_sampler();
+}
+
+POLYBAR_NS_END
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <spawn.h>
+
 #include "common.hpp"
 
 POLYBAR_NS
@@ -10,6 +12,7 @@ namespace process_util {
 
   void exec(char* cmd, char** args);
   void exec_sh(const char* cmd);
+  pid_t spawn_sh(const char* cmd, const posix_spawn_file_actions_t* actions);
 
   pid_t wait_for_completion(pid_t process_id, int* status_addr, int waitflags = 0);
   pid_t wait_for_completion(int* status_addr, int waitflags = 0);
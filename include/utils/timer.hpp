@@ -0,0 +1,57 @@
+#pragma once
+
+#include <array>
+
+#include "common.hpp"
+
+POLYBAR_NS
+
+namespace timer_util {
+  /**
+   * Hierarchical timing wheel
+   *
+   * Timers are identified by id and scheduled in ticks. Each level
+   * holds 64 slots covering 64 times the range of the level below,
+   * and timers are cascaded down as their expiry gets closer, so
+   * adding, expiring and finding the next deadline don't depend on
+   * the number of scheduled timers
+   *
+   * Example usage:
+   * @code cpp
+   *   timer_util::timer_wheel wheel{now};
+   *   wheel.add(id, now + 1000);
+   *   ...
+   *   wheel.advance(now, expired);
+   * @endcode
+   */
+  class timer_wheel {
+   public:
+    static constexpr size_t SLOT_BITS{6U};
+    static constexpr size_t SLOTS{1U << SLOT_BITS};
+    static constexpr size_t LEVELS{4U};
+
+    explicit timer_wheel(uint64_t now = 0U);
+
+    void add(size_t id, uint64_t deadline);
+    bool remove(size_t id);
+    void advance(uint64_t until, vector<size_t>& expired);
+    bool next_deadline(uint64_t& deadline) const;
+    size_t size() const;
+
+   protected:
+    struct entry {
+      size_t id;
+      uint64_t deadline;
+    };
+
+    void insert(const entry& e);
+    void cascade(size_t level, size_t slot);
+
+   private:
+    array<array<vector<entry>, SLOTS>, LEVELS> m_slots;
+    array<size_t, LEVELS> m_counts{};
+    uint64_t m_base;
+  };
+}
+
+POLYBAR_NS_END
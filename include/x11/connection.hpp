@@ -9,6 +9,7 @@
 
 #include "common.hpp"
 #include "x11/extensions.hpp"
+#include "x11/properties.hpp"
 #include "x11/registry.hpp"
 #include "x11/types.hpp"
 
@@ -77,6 +78,8 @@ class connection : public xpp_connection {
 
   void dispatch_event(const shared_ptr<xcb_generic_event_t>& evt) const;
 
+  property_cache& properties() const;
+
   /**
    * Attach sink to the registry */
   template <typename Sink>
@@ -94,6 +97,7 @@ class connection : public xpp_connection {
 
  protected:
   registry m_registry{*this};
+  mutable property_cache m_properties{*this};
   xcb_screen_t* m_screen{nullptr};
   int m_connection_fd{0};
 };
@@ -7,7 +7,9 @@
 
 POLYBAR_NS
 
+class connection;
 struct position;
+struct property;
 
 using ewmh_connection_t = memory_util::malloc_ptr_t<xcb_ewmh_connection_t>;
 
@@ -26,6 +28,18 @@ namespace ewmh_util {
   uint32_t get_current_desktop(xcb_ewmh_connection_t* conn, int screen = 0);
   xcb_window_t get_active_window(xcb_ewmh_connection_t* conn, int screen = 0);
 
+  xcb_window_t get_active_window(connection& conn);
+  uint32_t get_current_desktop(connection& conn);
+  uint32_t get_desktops(connection& conn, vector<string>& names, vector<position>* viewports = nullptr);
+  string get_window_title(connection& conn, xcb_window_t win);
+
+  uint32_t get_cardinal(const property& prop);
+  vector<string> get_strings(const property& prop);
+  vector<string> get_strings(const char* data, size_t len);
+
+  vector<position> get_viewports_reply(xcb_ewmh_connection_t* conn, xcb_get_property_cookie_t cookie);
+  vector<string> get_names_reply(xcb_ewmh_connection_t* conn, xcb_get_property_cookie_t cookie);
+
   void change_current_desktop(xcb_ewmh_connection_t* conn, uint32_t desktop);
 }
 
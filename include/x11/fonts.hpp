@@ -2,6 +2,7 @@
 
 #include <X11/Xft/Xft.h>
 #include <xcb/xcbext.h>
+#include <unordered_map>
 
 #include "common.hpp"
 #include "components/logger.hpp"
@@ -13,9 +14,19 @@ POLYBAR_NS
 // fwd
 class connection;
 
-#define XFT_MAXCHARS (1 << 16)
-extern array<char, XFT_MAXCHARS> xft_widths;
-extern array<wchar_t, XFT_MAXCHARS> xft_chars;
+struct glyph_info {
+  bool exists{false};
+  uint16_t width{0U};
+};
+
+struct glyph_cache_stats {
+  // Font resolved per (preferred font index, codepoint)
+  size_t match_hits{0U};
+  size_t match_misses{0U};
+  // Glyph info per font and codepoint
+  size_t glyph_hits{0U};
+  size_t glyph_misses{0U};
+};
 
 struct fonttype {
   fonttype() {}
@@ -29,14 +40,13 @@ struct fonttype {
   uint16_t char_max = 0;
   uint16_t char_min = 0;
   vector<xcb_charinfo_t> width_lut;
+  std::unordered_map<uint32_t, glyph_info> glyphs;
 };
 
 struct fonttype_deleter {
   void operator()(fonttype* f);
 };
 
-using font_t = unique_ptr<fonttype, fonttype_deleter>;
-
 class font_manager {
  public:
   explicit font_manager(connection& conn, const logger& logger);
@@ -46,8 +56,8 @@ class font_manager {
 
   void set_preferred_font(int8_t index);
 
-  font_t& match_char(uint16_t chr);
-  uint8_t char_width(font_t& font, uint16_t chr);
+  font_t& match_char(uint32_t chr);
+  uint16_t char_width(font_t& font, uint32_t chr);
 
   XftColor xftcolor();
   XftDraw* xftdraw();
@@ -59,9 +69,12 @@ class font_manager {
 
   void set_gcontext_font(xcb_gcontext_t gc, xcb_font_t font);
 
+  const glyph_cache_stats& cache_stats() const;
+
  protected:
   bool open_xcb_font(font_t& fontptr, string fontname);
-  bool has_glyph(font_t& font, uint16_t chr);
+  bool has_glyph(font_t& font, uint32_t chr);
+  glyph_info& lookup_glyph(font_t& font, uint32_t chr);
 
  private:
   connection& m_connection;
@@ -74,6 +87,10 @@ class font_manager {
   map<uint8_t, font_t> m_fonts;
   int8_t m_fontindex{DEFAULT_FONT_INDEX};
 
+  // Resolved font for each (preferred font index, codepoint) pair
+  std::unordered_map<uint64_t, font_t*> m_matches;
+  glyph_cache_stats m_cachestats{};
+
   XftColor m_xftcolor{};
   XftDraw* m_xftdraw{nullptr};
 };
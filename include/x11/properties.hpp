@@ -0,0 +1,72 @@
+#pragma once
+
+#include <xcb/xcb.h>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+
+#include "common.hpp"
+
+POLYBAR_NS
+
+/**
+ * Raw value of a window property
+ */
+struct property {
+  xcb_atom_t type{XCB_NONE};
+  uint8_t format{0};
+  uint32_t length{0};
+  string data;
+
+  /**
+   * Get property value as an array of `length` items
+   */
+  template <typename T>
+  const T* values() const {
+    return reinterpret_cast<const T*>(data.data());
+  }
+};
+
+using property_t = shared_ptr<const property>;
+
+/**
+ * Connection level cache of window properties
+ *
+ * Only properties of watched windows are cached, since those
+ * are the windows we receive PropertyNotify events for. The
+ * events are passed to invalidate() by the connection before
+ * they reach the registry, so sinks always read fresh values
+ */
+class property_cache {
+ public:
+  explicit property_cache(xcb_connection_t* conn);
+
+  void watch(xcb_window_t win, const void* owner);
+  void unwatch(xcb_window_t win, const void* owner);
+
+  property_t get(xcb_window_t win, xcb_atom_t atom);
+  vector<property_t> get(xcb_window_t win, const vector<xcb_atom_t>& atoms);
+
+  void invalidate(xcb_window_t win, xcb_atom_t atom);
+
+  size_t hits() const;
+  size_t misses() const;
+
+ protected:
+  static uint64_t make_key(xcb_window_t win, xcb_atom_t atom);
+
+  virtual vector<property_t> fetch(xcb_window_t win, const vector<xcb_atom_t>& atoms);
+
+ private:
+  xcb_connection_t* m_connection;
+
+  mutable std::mutex m_lock;
+  std::unordered_map<xcb_window_t, std::set<const void*>> m_watched;
+  std::unordered_map<uint64_t, property_t> m_properties;
+  uint64_t m_generation{0U};
+
+  size_t m_hits{0U};
+  size_t m_misses{0U};
+};
+
+POLYBAR_NS_END
@@ -8,6 +8,8 @@ POLYBAR_NS
 
 class connection;
 class registry;
+struct fonttype;
+struct fonttype_deleter;
 
 using gcontext = xpp::gcontext<connection&>;
 using pixmap = xpp::pixmap<connection&>;
@@ -16,6 +18,7 @@ using colormap = xpp::colormap<connection&>;
 using atom = xpp::atom<connection&>;
 using font = xpp::font<connection&>;
 using cursor = xpp::cursor<connection&>;
+using font_t = unique_ptr<fonttype, fonttype_deleter>;
 
 namespace reply_checked = xpp::x::reply::checked;
 namespace reply_unchecked = xpp::x::reply::unchecked;
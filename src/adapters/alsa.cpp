@@ -111,6 +111,26 @@ void alsa_ctl_interface::process_events() {
   wait(0);
 }
 
+/**
+ * Get the descriptors that become readable on control events
+ */
+vector<int> alsa_ctl_interface::get_file_descriptors() {
+  assert(m_ctl);
+
+  std::lock_guard<std::mutex> guard(m_lock);
+
+  vector<struct pollfd> pfds(snd_ctl_poll_descriptors_count(m_ctl));
+  vector<int> fds;
+
+  int count = snd_ctl_poll_descriptors(m_ctl, pfds.data(), pfds.size());
+
+  for (int i = 0; i < count; i++) {
+    fds.emplace_back(pfds[i].fd);
+  }
+
+  return fds;
+}
+
 // }}}
 // class : alsa_mixer {{{
 
@@ -198,6 +218,26 @@ int alsa_mixer::process_events() {
   return num_events;
 }
 
+/**
+ * Get the descriptors that become readable on mixer events
+ */
+vector<int> alsa_mixer::get_file_descriptors() {
+  assert(m_hardwaremixer);
+
+  std::lock_guard<std::mutex> guard(m_lock);
+
+  vector<struct pollfd> pfds(snd_mixer_poll_descriptors_count(m_hardwaremixer));
+  vector<int> fds;
+
+  int count = snd_mixer_poll_descriptors(m_hardwaremixer, pfds.data(), pfds.size());
+
+  for (int i = 0; i < count; i++) {
+    fds.emplace_back(pfds[i].fd);
+  }
+
+  return fds;
+}
+
 int alsa_mixer::get_volume() {
   if (!m_lock.try_lock()) {
     return 0;
@@ -10,9 +10,14 @@
 
 #include <linux/ethtool.h>
 #include <linux/if_link.h>
+#include <linux/rtnetlink.h>
 #include <linux/sockios.h>
 #include <net/if.h>
+#include <linux/if.h>
 #include <netinet/in.h>
+#include <netinet/ip_icmp.h>
+#include <poll.h>
+#include <sys/eventfd.h>
 #include <sys/socket.h>
 #include <climits>
 #include <csignal>
@@ -23,7 +28,6 @@
 
 #include "common.hpp"
 #include "config.hpp"
-#include "utils/command.hpp"
 #include "utils/file.hpp"
 #include "utils/string.hpp"
 
@@ -43,13 +47,33 @@ namespace net {
    * Construct network interface
    */
   network::network(string interface) : m_interface(move(interface)) {
-    if (if_nametoindex(m_interface.c_str()) == 0) {
+    if ((m_ifindex = if_nametoindex(m_interface.c_str())) == 0) {
       throw network_error("Invalid network interface \"" + m_interface + "\"");
     }
     if ((m_socketfd = socket(AF_INET, SOCK_DGRAM, 0)) < 0) {
       throw network_error("Failed to open socket");
     }
+    if ((m_netlinkfd = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC | SOCK_NONBLOCK, NETLINK_ROUTE)) == -1) {
+      close(m_socketfd);
+      throw network_error("Failed to open netlink socket");
+    }
+
+    struct sockaddr_nl addr {};
+    addr.nl_family = AF_NETLINK;
+    addr.nl_groups = RTMGRP_LINK | RTMGRP_IPV4_IFADDR;
+
+    if (bind(m_netlinkfd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) == -1) {
+      close(m_netlinkfd);
+      close(m_socketfd);
+      throw network_error("Failed to bind netlink socket");
+    }
+
     check_tuntap();
+
+    // Get the initial state, later changes are notified
+    request(RTM_GETLINK, 0);
+    request(RTM_GETADDR, NLM_F_DUMP);
+    receive();
   }
 
   /**
@@ -59,71 +83,48 @@ namespace net {
     if (m_socketfd != -1) {
       close(m_socketfd);
     }
+    if (m_netlinkfd != -1) {
+      close(m_netlinkfd);
+    }
   }
 
   /**
-   * Query device driver for information
+   * Sample the traffic counters
+   *
+   * Only the configured interface is requested,
+   * unless the counters of all interfaces are summed up
    */
   bool network::query(bool accumulate) {
-    struct ifaddrs* ifaddr;
-
-    if (getifaddrs(&ifaddr) == -1 || ifaddr == nullptr) {
-      return false;
-    }
-
     m_status.previous = m_status.current;
     m_status.current.transmitted = 0;
     m_status.current.received = 0;
     m_status.current.time = chrono::system_clock::now();
 
-    for (auto ifa = ifaddr; ifa != nullptr; ifa = ifa->ifa_next) {
-      if (ifa->ifa_addr == nullptr) {
-        continue;
-      }
-
-      if (m_interface.compare(0, m_interface.length(), ifa->ifa_name) != 0) {
-        if (!accumulate || (ifa->ifa_data == nullptr && ifa->ifa_addr->sa_family != AF_PACKET)) {
-          continue;
-        }
-      }
-
-      switch (ifa->ifa_addr->sa_family) {
-        case AF_INET:
-          char ip_buffer[NI_MAXHOST];
-          getnameinfo(ifa->ifa_addr, sizeof(sockaddr_in), ip_buffer, NI_MAXHOST, nullptr, 0, NI_NUMERICHOST);
-          m_status.ip = string{ip_buffer};
-          break;
-
-        case AF_PACKET:
-          if (ifa->ifa_data == nullptr) {
-            continue;
-          }
-          struct rtnl_link_stats* link_state = reinterpret_cast<decltype(link_state)>(ifa->ifa_data);
-          if (link_state == nullptr) {
-            continue;
-          }
-          m_status.current.transmitted += link_state->tx_bytes;
-          m_status.current.received += link_state->rx_bytes;
-          break;
-      }
+    if ((m_pending = request(RTM_GETLINK, accumulate ? NLM_F_DUMP : 0)) == 0) {
+      return false;
     }
 
-    freeifaddrs(ifaddr);
+    receive(accumulate);
+    m_pending = 0;
 
     return true;
   }
 
   /**
-   * Run ping command to test internet connectivity
+   * Process pending link and address notifications
+   *
+   * Returns true if the state of the interface changed
    */
-  bool network::ping() const {
-    try {
-      auto exec = "ping -c 2 -W 2 -I " + m_interface + " " + string(CONNECTION_TEST_IP);
-      auto ping = command_util::make_command(exec);
-      return ping && ping->exec(true) == EXIT_SUCCESS;
-    } catch (const std::exception& err) {
-      return false;
-    }
+  bool network::process_events() {
+    return receive();
+  }
+
+  /**
+   * Get the netlink socket, readable when
+   * notifications are pending
+   */
+  int network::get_file_descriptor() const {
+    return m_netlinkfd;
   }
 
   /**
@@ -149,6 +150,20 @@ namespace net {
     return format_speedrate(bytes_diff, minwidth);
   }
 
+  /**
+   * Get download speed rate in bytes per second
+   */
+  float network::downspeed_rate() const {
+    return speedrate(m_status.current.received - m_status.previous.received);
+  }
+
+  /**
+   * Get upload speed rate in bytes per second
+   */
+  float network::upspeed_rate() const {
+    return speedrate(m_status.current.transmitted - m_status.previous.transmitted);
+  }
+
   /**
    * Query driver info to check if the
    * interface is a TUN/TAP device
@@ -181,17 +196,194 @@ namespace net {
    * Test if the network interface is in a valid state
    */
   bool network::test_interface() const {
-    auto operstate = file_util::get_contents("/sys/class/net/" + m_interface + "/operstate");
-    return operstate.compare(0, 2, "up") == 0;
+    return m_operstate == IF_OPER_UP;
   }
 
   /**
-   * Format up- and download speed
+   * Send request for the configured interface, or a dump of all
+   * interfaces if NLM_F_DUMP is set. Returns the sequence number
+   * of the request or 0 if it couldn't be sent
    */
-  string network::format_speedrate(float bytes_diff, int minwidth) const {
+  uint32_t network::request(uint16_t type, uint16_t flags) {
+    alignas(struct nlmsghdr) char buffer[NLMSG_SPACE(sizeof(struct ifinfomsg))]{};
+    auto header = reinterpret_cast<struct nlmsghdr*>(buffer);
+
+    header->nlmsg_type = type;
+    header->nlmsg_flags = NLM_F_REQUEST | flags;
+    header->nlmsg_seq = ++m_sequence ? m_sequence : ++m_sequence;
+
+    if (type == RTM_GETADDR) {
+      auto msg = static_cast<struct ifaddrmsg*>(NLMSG_DATA(header));
+      msg->ifa_family = AF_INET;
+      msg->ifa_index = m_ifindex;
+      header->nlmsg_len = NLMSG_LENGTH(sizeof(struct ifaddrmsg));
+    } else {
+      auto msg = static_cast<struct ifinfomsg*>(NLMSG_DATA(header));
+      msg->ifi_family = AF_UNSPEC;
+      msg->ifi_index = (flags & NLM_F_DUMP) ? 0 : m_ifindex;
+      header->nlmsg_len = NLMSG_LENGTH(sizeof(struct ifinfomsg));
+    }
+
+    while (send(m_netlinkfd, buffer, header->nlmsg_len, 0) == -1) {
+      if (errno != EINTR) {
+        return 0;
+      }
+    }
+
+    return header->nlmsg_seq;
+  }
+
+  /**
+   * Read all messages queued on the netlink socket
+   *
+   * Replies are queued as soon as the request is sent and dumps
+   * continue while reading, so the socket is drained without
+   * blocking. Returns true if the state of the interface changed
+   */
+  bool network::receive(bool accumulate) {
+    alignas(struct nlmsghdr) char buffer[8192];
+    bool changed{false};
+
+    while (true) {
+      ssize_t bytes{recv(m_netlinkfd, buffer, sizeof(buffer), 0)};
+
+      if (bytes == -1 && errno == EINTR) {
+        continue;
+      } else if (bytes == -1 && errno == ENOBUFS) {
+        // Notifications were dropped, request the whole state again
+        request(RTM_GETLINK, 0);
+        request(RTM_GETADDR, NLM_F_DUMP);
+        changed = true;
+        continue;
+      } else if (bytes <= 0) {
+        break;
+      }
+
+      int length{static_cast<int>(bytes)};
+
+      for (auto msg = reinterpret_cast<struct nlmsghdr*>(buffer); NLMSG_OK(msg, length);
+           msg = NLMSG_NEXT(msg, length)) {
+        switch (msg->nlmsg_type) {
+          case RTM_NEWLINK:
+          case RTM_DELLINK:
+            changed |= parse_link(msg, accumulate);
+            break;
+          case RTM_NEWADDR:
+          case RTM_DELADDR:
+            changed |= parse_address(msg);
+            break;
+        }
+      }
+    }
+
+    return changed;
+  }
+
+  /**
+   * Process link message
+   *
+   * Replies to the pending query add their counters to the current
+   * sample. Returns true if the state of the interface changed
+   */
+  bool network::parse_link(const struct nlmsghdr* msg, bool accumulate) {
+    auto info = static_cast<const struct ifinfomsg*>(NLMSG_DATA(msg));
+    int length{static_cast<int>(IFLA_PAYLOAD(msg))};
+
+    string name;
+    uint8_t operstate{IF_OPER_UNKNOWN};
+    bool carrier{(info->ifi_flags & IFF_LOWER_UP) != 0};
+
+    for (auto attr = IFLA_RTA(info); RTA_OK(attr, length); attr = RTA_NEXT(attr, length)) {
+      if (attr->rta_type == IFLA_IFNAME) {
+        name = static_cast<const char*>(RTA_DATA(attr));
+      } else if (attr->rta_type == IFLA_OPERSTATE) {
+        operstate = *static_cast<const uint8_t*>(RTA_DATA(attr));
+      } else if (attr->rta_type == IFLA_STATS64 && m_pending != 0 && msg->nlmsg_seq == m_pending &&
+                 (accumulate || info->ifi_index == m_ifindex)) {
+        struct rtnl_link_stats64 stats;
+        memcpy(&stats, RTA_DATA(attr), sizeof(stats));
+        m_status.current.transmitted += stats.tx_bytes;
+        m_status.current.received += stats.rx_bytes;
+      }
+    }
+
+    // The interface has been created again
+    if (msg->nlmsg_type == RTM_NEWLINK && info->ifi_index != m_ifindex && name == m_interface) {
+      m_ifindex = info->ifi_index;
+      m_status.ip.clear();
+      request(RTM_GETADDR, NLM_F_DUMP);
+    }
+
+    if (info->ifi_index != m_ifindex) {
+      return false;
+    } else if (msg->nlmsg_type == RTM_DELLINK) {
+      operstate = IF_OPER_NOTPRESENT;
+      carrier = false;
+    }
+
+    bool changed{operstate != m_operstate || carrier != m_carrier};
+    m_operstate = operstate;
+    m_carrier = carrier;
+    m_linkchanged = m_linkchanged || changed;
+
+    return changed;
+  }
+
+  /**
+   * Process IPv4 address message for the interface
+   *
+   * Returns true if the address changed
+   */
+  bool network::parse_address(const struct nlmsghdr* msg) {
+    auto info = static_cast<const struct ifaddrmsg*>(NLMSG_DATA(msg));
+    int length{static_cast<int>(IFA_PAYLOAD(msg))};
+
+    if (info->ifa_family != AF_INET || static_cast<int>(info->ifa_index) != m_ifindex) {
+      return false;
+    }
+
+    string ip;
+
+    // IFA_ADDRESS is the peer address on point-to-point links
+    for (auto attr = IFA_RTA(info); RTA_OK(attr, length); attr = RTA_NEXT(attr, length)) {
+      if (attr->rta_type == IFA_LOCAL || (attr->rta_type == IFA_ADDRESS && ip.empty())) {
+        char buffer[INET_ADDRSTRLEN];
+        if (inet_ntop(AF_INET, RTA_DATA(attr), buffer, sizeof(buffer)) != nullptr) {
+          ip = buffer;
+        }
+      }
+    }
+
+    if (msg->nlmsg_type == RTM_DELADDR) {
+      if (ip != m_status.ip) {
+        return false;
+      }
+      // Another address may still be assigned
+      m_status.ip.clear();
+      request(RTM_GETADDR, NLM_F_DUMP);
+    } else if (ip == m_status.ip) {
+      return false;
+    } else {
+      m_status.ip = ip;
+    }
+
+    return true;
+  }
+
+  /**
+   * Get the rate of transferred bytes per second
+   */
+  float network::speedrate(float bytes_diff) const {
     const auto duration = m_status.current.time - m_status.previous.time;
     float time_diff = chrono::duration_cast<chrono::seconds>(duration).count();
-    float speedrate = bytes_diff / (time_diff ? time_diff : 1);
+    return bytes_diff / (time_diff ? time_diff : 1);
+  }
+
+  /**
+   * Format up- and download speed
+   */
+  string network::format_speedrate(float bytes_diff, int minwidth) const {
+    float speedrate = this->speedrate(bytes_diff);
 
     vector<string> suffixes{"GB", "MB"};
     string suffix{"KB"};
@@ -213,11 +405,19 @@ namespace net {
    */
   bool wired_network::query(bool accumulate) {
     if (m_tuntap) {
+      // Still pick up link changes when running without the reactor,
+      // which would otherwise drain the notifications
+      process_events();
       return true;
     } else if (!network::query(accumulate)) {
       return false;
     }
 
+    // The link speed only changes with the link state
+    if (!m_linkchanged) {
+      return true;
+    }
+
     struct ifreq request;
     struct ethtool_cmd data;
 
@@ -230,6 +430,7 @@ namespace net {
     }
 
     m_linkspeed = data.speed;
+    m_linkchanged = false;
 
     return true;
   }
@@ -241,19 +442,7 @@ namespace net {
     if (!m_tuntap && !network::test_interface()) {
       return false;
     }
-
-    struct ethtool_value data;
-    struct ifreq request;
-
-    strncpy(request.ifr_name, m_interface.c_str(), IFNAMSIZ - 1);
-    data.cmd = ETHTOOL_GLINK;
-    request.ifr_data = reinterpret_cast<caddr_t>(&data);
-
-    if (ioctl(m_socketfd, SIOCETHTOOL, &request) == -1) {
-      return false;
-    }
-
-    return data.data != 0;
+    return m_carrier;
   }
 
   /**
@@ -276,15 +465,11 @@ namespace net {
       return false;
     }
 
-    auto socket_fd = iw_sockets_open();
-
-    if (socket_fd == -1) {
-      return false;
-    }
-
     struct iwreq req;
 
-    if (iw_get_ext(socket_fd, m_interface.c_str(), SIOCGIWMODE, &req) == -1) {
+    // Wireless extension requests are ioctls on any
+    // socket, so the interface socket is reused
+    if (iw_get_ext(m_socketfd, m_interface.c_str(), SIOCGIWMODE, &req) == -1) {
       return false;
     }
 
@@ -293,10 +478,8 @@ namespace net {
       return false;
     }
 
-    query_essid(socket_fd);
-    query_quality(socket_fd);
-
-    iw_sockets_close(socket_fd);
+    query_essid(m_socketfd);
+    query_quality(m_socketfd);
 
     return true;
   }
@@ -394,6 +577,205 @@ namespace net {
     }
   }
 
+  // }}}
+  // class : connectivity_probe {{{
+
+  /**
+   * Construct probe sending requests to the given IPv4 address
+   */
+  connectivity_probe::connectivity_probe(
+      const string& host, duration_t interval, duration_t timeout, callback<> on_change)
+      : m_interval(interval), m_timeout(timeout), m_callback(move(on_change)) {
+    m_address.sin_family = AF_INET;
+
+    if (inet_pton(AF_INET, host.c_str(), &m_address.sin_addr) != 1) {
+      throw network_error("Invalid connectivity test address \"" + host + "\"");
+    }
+    if ((m_wakeupfd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)) == -1) {
+      throw network_error("Failed to create wakeup eventfd");
+    }
+  }
+
+  /**
+   * Deconstruct probe and wait for the running test
+   */
+  connectivity_probe::~connectivity_probe() {
+    stop();
+    close(m_wakeupfd);
+  }
+
+  /**
+   * Start probe thread
+   */
+  void connectivity_probe::start() {
+    if (m_active.exchange(true)) {
+      return;
+    }
+    m_thread = thread(&connectivity_probe::runner, this);
+  }
+
+  /**
+   * Stop probe thread, interrupting the running test
+   */
+  void connectivity_probe::stop() {
+    if (!m_active.exchange(false)) {
+      return;
+    }
+    eventfd_write(m_wakeupfd, 1);
+    if (m_thread.joinable()) {
+      m_thread.join();
+    }
+  }
+
+  /**
+   * Send requests from the given address, like ping -I
+   */
+  void connectivity_probe::set_source(const string& ip) {
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_source = ip;
+  }
+
+  /**
+   * Result of the last test, true until a test has failed
+   */
+  bool connectivity_probe::reachable() const {
+    return m_reachable;
+  }
+
+  /**
+   * Round trip time of the last test in milliseconds,
+   * or -1 if it failed
+   */
+  int connectivity_probe::latency() const {
+    return m_latency;
+  }
+
+  /**
+   * Probe thread
+   */
+  void connectivity_probe::runner() {
+    while (m_active) {
+      int latency{-1};
+      bool reachable{probe(latency)};
+
+      if (!m_active) {
+        break;
+      }
+
+      m_latency = reachable ? latency : -1;
+
+      if (m_reachable.exchange(reachable) != reachable && m_callback) {
+        m_callback();
+      }
+
+      wait(m_interval);
+    }
+  }
+
+  /**
+   * Run a single test
+   */
+  bool connectivity_probe::probe(int& latency) {
+    int fd{-1};
+
+    // Unprivileged ICMP sockets are limited by net.ipv4.ping_group_range
+    if (m_icmp && (fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, IPPROTO_ICMP)) == -1) {
+      m_icmp = false;
+    }
+    if (!m_icmp && (fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0)) == -1) {
+      return false;
+    }
+
+    {
+      std::lock_guard<std::mutex> guard(m_lock);
+      struct sockaddr_in source {};
+      source.sin_family = AF_INET;
+
+      if (!m_source.empty() && inet_pton(AF_INET, m_source.c_str(), &source.sin_addr) == 1) {
+        bind(fd, reinterpret_cast<struct sockaddr*>(&source), sizeof(source));
+      }
+    }
+
+    auto start = clock_t::now();
+    auto deadline = start + chrono::duration_cast<clock_t::duration>(m_timeout);
+    bool sent;
+
+    if (m_icmp) {
+      struct icmphdr request {};
+      request.type = ICMP_ECHO;
+      request.un.echo.sequence = htons(++m_sequence);
+      sent = sendto(fd, &request, sizeof(request), 0, reinterpret_cast<struct sockaddr*>(&m_address),
+                 sizeof(m_address)) != -1;
+    } else {
+      // Refused connections tell just as well that the host is reachable
+      struct sockaddr_in address = m_address;
+      address.sin_port = htons(53);
+      sent = connect(fd, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) == 0 || errno == EINPROGRESS;
+    }
+
+    bool reachable{sent && await_reply(fd, m_icmp, deadline)};
+    latency = chrono::duration_cast<chrono::milliseconds>(clock_t::now() - start).count();
+
+    close(fd);
+
+    return reachable;
+  }
+
+  /**
+   * Wait for the echo reply or the connection to complete
+   */
+  bool connectivity_probe::await_reply(int fd, bool icmp, clock_t::time_point deadline) {
+    while (m_active) {
+      auto timeout = chrono::duration_cast<chrono::milliseconds>(deadline - clock_t::now()).count();
+
+      if (timeout <= 0) {
+        return false;
+      }
+
+      struct pollfd fds[2]{{fd, static_cast<short>(icmp ? POLLIN : POLLOUT), 0}, {m_wakeupfd, POLLIN, 0}};
+
+      if (poll(fds, 2, static_cast<int>(timeout)) == -1) {
+        if (errno == EINTR) {
+          continue;
+        }
+        return false;
+      } else if (fds[1].revents & POLLIN) {
+        return false;
+      } else if (!icmp && fds[0].revents) {
+        int error{0};
+        socklen_t length{sizeof(error)};
+        getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &length);
+        return error == 0 || error == ECONNREFUSED;
+      } else if (fds[0].revents) {
+        struct icmphdr reply {};
+        ssize_t bytes{recv(fd, &reply, sizeof(reply), 0)};
+
+        if (bytes == -1 && errno != EAGAIN && errno != EINTR) {
+          return false;
+        } else if (bytes >= static_cast<ssize_t>(sizeof(reply)) && reply.type == ICMP_ECHOREPLY &&
+                   ntohs(reply.un.echo.sequence) == m_sequence) {
+          return true;
+        }
+
+        // Replies to earlier requests arriving late are skipped
+      }
+    }
+
+    return false;
+  }
+
+  /**
+   * Sleep until the next test is due or the probe is stopped
+   */
+  void connectivity_probe::wait(duration_t duration) {
+    struct pollfd fds[1]{{m_wakeupfd, POLLIN, 0}};
+
+    if (poll(fds, 1, static_cast<int>(duration.count())) > 0) {
+      eventfd_t value;
+      eventfd_read(m_wakeupfd, &value);
+    }
+  }
+
   // }}}
 }
 
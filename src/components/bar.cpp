@@ -24,8 +24,6 @@
 
 POLYBAR_NS
 
-namespace ph = std::placeholders;
-
 /**
  * Configure injection module
  */
@@ -175,23 +173,6 @@ void bar::bootstrap(bool nodraw) {
   // Required by Openbox
   reconfigure_pos();
 
-  m_log.trace("bar: Attach parser signal handlers");
-  g_signals::parser::background_change = bind(&renderer::set_background, m_renderer.get(), ph::_1);
-  g_signals::parser::foreground_change = bind(&renderer::set_foreground, m_renderer.get(), ph::_1);
-  g_signals::parser::underline_change = bind(&renderer::set_underline, m_renderer.get(), ph::_1);
-  g_signals::parser::overline_change = bind(&renderer::set_overline, m_renderer.get(), ph::_1);
-  g_signals::parser::pixel_offset = bind(&renderer::fill_shift, m_renderer.get(), ph::_1);
-  g_signals::parser::alignment_change = bind(&renderer::set_alignment, m_renderer.get(), ph::_1);
-  g_signals::parser::attribute_set = bind(&renderer::set_attribute, m_renderer.get(), ph::_1, true);
-  g_signals::parser::attribute_unset = bind(&renderer::set_attribute, m_renderer.get(), ph::_1, false);
-  g_signals::parser::attribute_toggle = bind(&renderer::toggle_attribute, m_renderer.get(), ph::_1);
-  g_signals::parser::action_block_open = bind(&renderer::begin_action, m_renderer.get(), ph::_1, ph::_2);
-  g_signals::parser::action_block_close = bind(&renderer::end_action, m_renderer.get(), ph::_1);
-  g_signals::parser::font_change = bind(&renderer::set_fontindex, m_renderer.get(), ph::_1);
-  g_signals::parser::ascii_text_write = bind(&renderer::draw_character, m_renderer.get(), ph::_1);
-  g_signals::parser::unicode_text_write = bind(&renderer::draw_character, m_renderer.get(), ph::_1);
-  g_signals::parser::string_write = bind(&renderer::draw_textstring, m_renderer.get(), ph::_1, ph::_2);
-
   try {
     m_log.trace("bar: Drawing empty bar");
     m_renderer->begin();
@@ -366,9 +347,101 @@ void bar::parse(const string& data, bool force) {
   }
 
   m_lastinput = data;
+  m_lastsegments.clear();
+
+  try {
+    m_parser(data, m_compiled);
+  } catch (const parser_error& err) {
+    m_log.err("Failed to parse contents (reason: %s)", err.what());
+  }
+
+  if (m_compiled == m_drawlist && !force) {
+    return m_log.trace_x("bar: Ignoring unchanged draw list");
+  }
+
+  std::swap(m_compiled, m_drawlist);
+
+  m_renderer->begin();
+
+  reserve_tray_space();
+
+  m_renderer->fill_background();
+  m_renderer->render(m_drawlist);
+  m_renderer->end();
+}
+
+/**
+ * Parse the contents of each module separately and
+ * redraw only the segments that have changed
+ *
+ * @param segments Input strings for each module, grouped by alignment
+ * @param force Unless true, do not parse unchanged segments
+ */
+void bar::parse(const segmentmap_t& segments, bool force) {
+  if (!m_mutex.try_lock()) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> guard(m_mutex, std::adopt_lock);
+
+  if (segments == m_lastsegments && !force) {
+    return;
+  }
+
+  bool redraw{force || m_lastsegments.empty()};
+
+  m_lastinput.clear();
+  m_drawlist.clear();
 
   m_renderer->begin();
 
+  reserve_tray_space();
+
+  if (redraw) {
+    m_renderer->fill_background();
+  }
+
+  for (auto&& block : segments) {
+    const auto& previous = m_lastsegments[block.first];
+    auto& lists = m_segmentlists[block.first];
+
+    lists.resize(block.second.size());
+    m_renderer->resize_segments(block.first, block.second.size());
+
+    for (size_t i = 0; i < block.second.size(); i++) {
+      if (!redraw && i < previous.size() && previous[i] == block.second[i]) {
+        continue;
+      }
+
+      try {
+        m_parser(block.second[i], m_compiled);
+      } catch (const parser_error& err) {
+        m_log.err("Failed to parse contents (reason: %s)", err.what());
+      }
+
+      // The markup changed but it still produces the same output
+      if (!redraw && m_compiled == lists[i]) {
+        continue;
+      }
+
+      std::swap(m_compiled, lists[i]);
+
+      m_renderer->begin_segment(block.first, i);
+      m_renderer->render(lists[i]);
+      m_renderer->end_segment();
+    }
+  }
+
+  m_renderer->compose_segments();
+  m_renderer->end();
+
+  m_lastsegments = segments;
+}
+
+/**
+ * Reserve the space occupied by the tray, unless detached
+ */
+void bar::reserve_tray_space() {
   if (m_tray && !m_tray->settings().detached && m_tray->settings().configured_slots) {
     if (m_tray->settings().align == alignment::LEFT) {
       m_renderer->reserve_space(edge::LEFT, m_tray->settings().configured_w);
@@ -376,17 +449,6 @@ void bar::parse(const string& data, bool force) {
       m_renderer->reserve_space(edge::RIGHT, m_tray->settings().configured_w);
     }
   }
-
-  m_renderer->fill_background();
-
-  try {
-    parser parser{m_log, m_opts};
-    parser(data);
-  } catch (const parser_error& err) {
-    m_log.err("Failed to parse contents (reason: %s)", err.what());
-  }
-
-  m_renderer->end();
 }
 
 /**
@@ -660,12 +722,21 @@ void bar::handle(const evt::button_press& evt) {
 /**
  * Event handler for XCB_EXPOSE events
  *
- * Used to redraw the bar
+ * Used to redraw the exposed areas of the bar once
+ * the last event of a series has been received.
+ * Waits for a frame being rendered so that its
+ * damage doesn't clobber the exposed spans
  */
 void bar::handle(const evt::expose& evt) {
-  if (evt->window == m_window && evt->count == 0) {
-    m_log.trace("bar: Received expose event");
-    m_renderer->flush(false);
+  if (evt->window == m_window) {
+    std::lock_guard<std::mutex> guard(m_mutex);
+
+    m_renderer->invalidate(evt->x, evt->y, evt->width, evt->height);
+
+    if (evt->count == 0) {
+      m_log.trace("bar: Received expose event");
+      m_renderer->flush(false);
+    }
   }
 }
 
@@ -692,4 +763,17 @@ void bar::handle(const evt::property_notify& evt) {
   }
 }
 
+/**
+ * Event handler for XCB_RANDR_SCREEN_CHANGE_NOTIFY events
+ *
+ * The bar is kept when its monitor is left unchanged, but
+ * the bottom strut depends on the height of the root window
+ */
+void bar::handle(const evt::randr_screen_change_notify& evt) {
+  if (evt->root == m_screen->root()) {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    reconfigure_struts();
+  }
+}
+
 POLYBAR_NS_END
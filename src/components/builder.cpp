@@ -503,6 +503,14 @@ void builder::cmd_close() {
   tag_close(syntaxtag::A);
 }
 
+/**
+ * Insert graph of comma separated percentages,
+ * drawn `step` pixels wide per sample
+ */
+void builder::graph(unsigned int step, const string& samples) {
+  tag_open(syntaxtag::G, to_string(step) + ":" + samples);
+}
+
 /**
  * Get default background hex string
  */
@@ -560,6 +568,9 @@ void builder::tag_open(syntaxtag tag, const string& value) {
     case syntaxtag::O:
       append("%{O" + value + "}");
       break;
+    case syntaxtag::G:
+      append("%{G" + value + "}");
+      break;
   }
 }
 
@@ -620,6 +631,8 @@ void builder::tag_close(syntaxtag tag) {
       break;
     case syntaxtag::O:
       break;
+    case syntaxtag::G:
+      break;
   }
 }
 
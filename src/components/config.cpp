@@ -44,6 +44,15 @@ void config::load(string file, string barname) {
   copy_inherited();
 }
 
+/**
+ * Load the config file again into a new instance
+ */
+unique_ptr<config> config::reload() const {
+  auto conf = make_unique<config>(m_logger, m_xrm);
+  conf->load(m_file, m_current_bar);
+  return conf;
+}
+
 /**
  * Look for sections set up to inherit from a base section
  * and copy the missing parameters
@@ -128,4 +137,83 @@ void config::warn_deprecated(const string& section, const string& key, string re
   }
 }
 
+/**
+ * Get the sections that were added, removed or
+ * modified in the given config
+ */
+vector<string> config::changed_sections(const config& other) const {
+  vector<string> sections;
+
+  for (auto&& section : m_ptree) {
+    auto it = other.m_ptree.find(section.first);
+    if (it == other.m_ptree.not_found() || it->second != section.second) {
+      sections.emplace_back(section.first);
+    }
+  }
+
+  for (auto&& section : other.m_ptree) {
+    if (m_ptree.find(section.first) == m_ptree.not_found()) {
+      sections.emplace_back(section.first);
+    }
+  }
+
+  return sections;
+}
+
+/**
+ * Extend the list of changed sections with the
+ * sections referencing them, directly or not
+ */
+vector<string> config::affected_sections(vector<string> changed) const {
+  bool found{true};
+
+  while (found) {
+    found = false;
+
+    for (auto&& section : m_ptree) {
+      if (std::find(changed.begin(), changed.end(), section.first) != changed.end()) {
+        continue;
+      }
+
+      for (size_t i = 0; i < changed.size(); i++) {
+        if (references(section.first, changed[i])) {
+          changed.emplace_back(section.first);
+          found = true;
+          break;
+        }
+      }
+    }
+  }
+
+  return changed;
+}
+
+/**
+ * Check if any parameter of the section references
+ * a parameter of the target section
+ */
+bool config::references(const string& section, const string& target) const {
+  auto it = m_ptree.find(section);
+
+  if (it == m_ptree.not_found()) {
+    return false;
+  }
+
+  for (auto&& param : it->second) {
+    auto value = param.second.get_value<string>();
+
+    if (value.find("${") == string::npos) {
+      continue;
+    } else if (value.find("${" + target + ".") != string::npos) {
+      return true;
+    } else if (target != bar_section()) {
+      continue;
+    } else if (value.find("${root.") != string::npos || value.find("${BAR.") != string::npos) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
 POLYBAR_NS_END
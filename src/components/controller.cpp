@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <chrono>
 #include <mutex>
 
@@ -80,9 +81,9 @@ controller::~controller() {
   sigaddset(&sig, SIGALRM);
   pthread_sigmask(SIG_BLOCK, &sig, nullptr);
 
-  if (m_command) {
-    m_log.info("Terminating running shell command");
-    m_command.reset();
+  if (m_executor) {
+    m_log.info("Terminating running shell commands");
+    m_executor.reset();
   }
 
   if (m_bar) {
@@ -117,6 +118,13 @@ controller::~controller() {
     ;
   }
 
+  size_t hits{m_connection.properties().hits()};
+  size_t misses{m_connection.properties().misses()};
+
+  if (hits || misses) {
+    m_log.info("Property cache served %lu of %lu value(s) without a round-trip", hits, hits + misses);
+  }
+
   m_connection.flush();
 }
 
@@ -132,6 +140,7 @@ void controller::bootstrap(bool writeback, bool dump_wmname) {
   }
 
   m_writeback = writeback;
+  m_incremental = m_conf.get<bool>(m_conf.bar_section(), "incremental-redraw", false);
 
   m_log.trace("controller: Initialize X atom cache");
   m_connection.preload_atoms();
@@ -169,6 +178,11 @@ void controller::bootstrap(bool writeback, bool dump_wmname) {
     m_log.trace("controller: Attach eventloop input callback");
     g_signals::bar::action_click = bind(&controller::on_mouse_event, this, placeholders::_1);
     m_eventloop->set_input_db(bind(&controller::on_unrecognized_action, this, placeholders::_1));
+
+    m_log.trace("controller: Create action executor");
+    m_executor = make_unique<executor>(m_log, m_conf.get<size_t>("settings", "action-max-running", 8),
+        m_conf.get<size_t>("settings", "action-max-pending", 32),
+        executor::duration_t{m_conf.get<double>("settings", "action-timeout", 0)});
   }
 
   m_log.trace("controller: Setup user-defined modules");
@@ -198,6 +212,11 @@ bool controller::run() {
     m_threads[thread_role::EVENT_QUEUE_X] = thread(&controller::wait_for_xevent, this);
   }
 
+  // Start running actions in the background
+  if (m_executor) {
+    m_executor->start();
+  }
+
   // Start event loop
   if (m_eventloop) {
     m_threads[thread_role::EVENT_QUEUE] = thread(&controller::wait_for_eventloop, this);
@@ -247,10 +266,28 @@ void controller::wait_for_configwatch() {
     m_log.trace("controller: Attach config watch");
     m_confwatch->attach(IN_MODIFY);
 
-    m_log.trace("controller: Wait for config file inotify event");
-    if (m_confwatch->await_match() && m_running) {
+    while (m_running) {
+      m_log.trace("controller: Wait for config file inotify event");
+      m_confwatch->await_match();
+
+      if (!m_running) {
+        break;
+      }
+
+      // Let the editor finish writing before parsing the file
+      while (m_confwatch->poll(50)) {
+        m_confwatch->get_event();
+      }
+
+      // Saving by replacing the file drops the watch
+      m_confwatch->attach(IN_MODIFY);
+
       m_log.info("Configuration file changed");
-      kill(getpid(), SIGUSR1);
+
+      if (!reload_config()) {
+        kill(getpid(), SIGUSR1);
+        break;
+      }
     }
   } catch (const system_error& err) {
     m_log.err(err.what());
@@ -336,69 +373,14 @@ void controller::bootstrap_modules() {
       }
 
       try {
-        auto type = m_conf.get<string>("module/" + module_name, "type");
-        module_t module;
-
-        if (type == "internal/counter") {
-          module.reset(new counter_module(bar, m_log, m_conf, module_name));
-        } else if (type == "internal/backlight") {
-          module.reset(new backlight_module(bar, m_log, m_conf, module_name));
-        } else if (type == "internal/battery") {
-          module.reset(new battery_module(bar, m_log, m_conf, module_name));
-        } else if (type == "internal/bspwm") {
-          module.reset(new bspwm_module(bar, m_log, m_conf, module_name));
-        } else if (type == "internal/cpu") {
-          module.reset(new cpu_module(bar, m_log, m_conf, module_name));
-        } else if (type == "internal/date") {
-          module.reset(new date_module(bar, m_log, m_conf, module_name));
-        } else if (type == "internal/fs") {
-          module.reset(new fs_module(bar, m_log, m_conf, module_name));
-        } else if (type == "internal/memory") {
-          module.reset(new memory_module(bar, m_log, m_conf, module_name));
-        } else if (type == "internal/i3") {
-          module.reset(new i3_module(bar, m_log, m_conf, module_name));
-        } else if (type == "internal/mpd") {
-          module.reset(new mpd_module(bar, m_log, m_conf, module_name));
-        } else if (type == "internal/volume") {
-          module.reset(new volume_module(bar, m_log, m_conf, module_name));
-        } else if (type == "internal/network") {
-          module.reset(new network_module(bar, m_log, m_conf, module_name));
-        } else if (type == "internal/temperature") {
-          module.reset(new temperature_module(bar, m_log, m_conf, module_name));
-        } else if (type == "internal/xbacklight") {
-          module.reset(new xbacklight_module(bar, m_log, m_conf, module_name));
-        } else if (type == "internal/xkeyboard") {
-          module.reset(new xkeyboard_module(bar, m_log, m_conf, module_name));
-        } else if (type == "internal/xwindow") {
-          module.reset(new xwindow_module(bar, m_log, m_conf, module_name));
-        } else if (type == "internal/xworkspaces") {
-          module.reset(new xworkspaces_module(bar, m_log, m_conf, module_name));
-        } else if (type == "custom/text") {
-          module.reset(new text_module(bar, m_log, m_conf, module_name));
-        } else if (type == "custom/script") {
-          module.reset(new script_module(bar, m_log, m_conf, module_name));
-        } else if (type == "custom/menu") {
-          module.reset(new menu_module(bar, m_log, m_conf, module_name));
-        } else if (type == "custom/ipc") {
-          if (!m_ipc) {
-            throw application_error("Inter-process messaging needs to be enabled");
-          }
-          module.reset(new ipc_module(bar, m_log, m_conf, module_name));
-          m_ipc->attach_callback(
-              bind(&ipc_module::on_message, static_cast<ipc_module*>(module.get()), placeholders::_1));
-        } else {
-          throw application_error("Unknown module: " + module_name);
-        }
-
-        module->set_update_cb(
-            bind(&eventloop::enqueue, m_eventloop.get(), eventloop::entry_t{static_cast<uint8_t>(event_type::UPDATE)}));
-        module->set_stop_cb(
-            bind(&eventloop::enqueue, m_eventloop.get(), eventloop::entry_t{static_cast<uint8_t>(event_type::CHECK)}));
+        auto module = make_module(bar, m_conf, module_name);
         module->setup();
 
         m_eventloop->add_module(align, move(module));
+        m_loaded_modules.emplace_back(module_name);
       } catch (const std::runtime_error& err) {
         m_log.err("Disabling module \"%s\" (reason: %s)", module_name, err.what());
+        m_disabled_modules.emplace_back(module_name);
       }
     }
   }
@@ -408,6 +390,197 @@ void controller::bootstrap_modules() {
   }
 }
 
+/**
+ * Create module defined in given config and
+ * attach the eventloop callbacks
+ */
+module_t controller::make_module(const bar_settings& bar, const config& conf, const string& module_name) {
+  auto type = conf.get<string>("module/" + module_name, "type");
+  module_t module;
+
+  if (type == "internal/counter") {
+    module.reset(new counter_module(bar, m_log, conf, module_name));
+  } else if (type == "internal/backlight") {
+    module.reset(new backlight_module(bar, m_log, conf, module_name));
+  } else if (type == "internal/battery") {
+    module.reset(new battery_module(bar, m_log, conf, module_name));
+  } else if (type == "internal/bspwm") {
+    module.reset(new bspwm_module(bar, m_log, conf, module_name));
+  } else if (type == "internal/cpu") {
+    module.reset(new cpu_module(bar, m_log, conf, module_name));
+  } else if (type == "internal/date") {
+    module.reset(new date_module(bar, m_log, conf, module_name));
+  } else if (type == "internal/fs") {
+    module.reset(new fs_module(bar, m_log, conf, module_name));
+  } else if (type == "internal/memory") {
+    module.reset(new memory_module(bar, m_log, conf, module_name));
+  } else if (type == "internal/i3") {
+    module.reset(new i3_module(bar, m_log, conf, module_name));
+  } else if (type == "internal/mpd") {
+    module.reset(new mpd_module(bar, m_log, conf, module_name));
+  } else if (type == "internal/volume") {
+    module.reset(new volume_module(bar, m_log, conf, module_name));
+  } else if (type == "internal/network") {
+    module.reset(new network_module(bar, m_log, conf, module_name));
+  } else if (type == "internal/temperature") {
+    module.reset(new temperature_module(bar, m_log, conf, module_name));
+  } else if (type == "internal/xbacklight") {
+    module.reset(new xbacklight_module(bar, m_log, conf, module_name));
+  } else if (type == "internal/xkeyboard") {
+    module.reset(new xkeyboard_module(bar, m_log, conf, module_name));
+  } else if (type == "internal/xwindow") {
+    module.reset(new xwindow_module(bar, m_log, conf, module_name));
+  } else if (type == "internal/xworkspaces") {
+    module.reset(new xworkspaces_module(bar, m_log, conf, module_name));
+  } else if (type == "custom/text") {
+    module.reset(new text_module(bar, m_log, conf, module_name));
+  } else if (type == "custom/script") {
+    module.reset(new script_module(bar, m_log, conf, module_name));
+  } else if (type == "custom/menu") {
+    module.reset(new menu_module(bar, m_log, conf, module_name));
+  } else if (type == "custom/ipc") {
+    if (!m_ipc) {
+      throw application_error("Inter-process messaging needs to be enabled");
+    }
+    module.reset(new ipc_module(bar, m_log, conf, module_name));
+    m_ipc->attach_callback(bind(&ipc_module::on_message, static_cast<ipc_module*>(module.get()), placeholders::_1));
+  } else {
+    throw application_error("Unknown module: " + module_name);
+  }
+
+  module->set_update_cb(bind(&eventloop::mark_dirty, m_eventloop.get(), module.get()));
+  module->set_stop_cb(
+      bind(&eventloop::enqueue, m_eventloop.get(), eventloop::entry_t{static_cast<uint8_t>(event_type::CHECK)}));
+
+  return module;
+}
+
+/**
+ * Apply changes made to the config file without restarting
+ *
+ * Only the modules whose section changed, or references a changed
+ * section, are rebuilt. The bar window, tray and other modules are
+ * left alone. Returns false if the change requires a full reload
+ */
+bool controller::reload_config() {
+  const config& current{m_configs.empty() ? m_conf : *m_configs.back()};
+  unique_ptr<config> conf;
+
+  try {
+    conf = current.reload();
+  } catch (const application_error& err) {
+    m_log.err("Failed to load changed config, keeping the current one (reason: %s)", err.what());
+    return true;
+  }
+
+  auto changed = current.changed_sections(*conf);
+
+  if (changed.empty()) {
+    m_log.info("No sections changed");
+    return true;
+  }
+
+  // The bar window, fonts and global settings are only set up
+  // on startup, changing them requires a full reload
+  auto affected = conf->affected_sections(move(changed));
+
+  for (auto&& section : affected) {
+    if (section == m_conf.bar_section() || section == "settings") {
+      m_log.info("Section [%s] changed, reloading application", section);
+      return false;
+    }
+  }
+
+  const bar_settings bar{m_bar->settings()};
+  vector<module_t> modules;
+
+  for (auto&& section : affected) {
+    if (section.compare(0, 7, "module/") != 0) {
+      continue;
+    }
+
+    auto module_name = section.substr(7);
+
+    if (std::find(m_disabled_modules.begin(), m_disabled_modules.end(), module_name) != m_disabled_modules.end()) {
+      m_log.info("Disabled module \"%s\" changed, reloading application", module_name);
+      return false;
+    } else if (std::find(m_loaded_modules.begin(), m_loaded_modules.end(), module_name) == m_loaded_modules.end()) {
+      continue;
+    }
+
+    // Message callbacks are bound to the ipc module instance, and modules
+    // listening for X events may only attach to the connection from the
+    // thread dispatching them
+    auto restart_required = [](const string& type) {
+      return type == "custom/ipc" || type == "internal/xbacklight" || type == "internal/xkeyboard" ||
+             type == "internal/xwindow" || type == "internal/xworkspaces";
+    };
+
+    if (restart_required(conf->get<string>(section, "type", "")) ||
+        restart_required(current.get<string>(section, "type", ""))) {
+      m_log.info("Module \"%s\" changed, reloading application", module_name);
+      return false;
+    }
+
+    // Rebuild every instance of modules listed more than once,
+    // or none of them if one fails
+    auto instances = std::count(m_loaded_modules.begin(), m_loaded_modules.end(), module_name);
+    vector<module_t> rebuilt;
+
+    try {
+      while (rebuilt.size() < static_cast<size_t>(instances)) {
+        auto module = make_module(bar, *conf, module_name);
+        module->setup();
+
+        if (!module->running()) {
+          break;
+        }
+
+        rebuilt.emplace_back(move(module));
+      }
+    } catch (const std::runtime_error& err) {
+      m_log.err("Keeping running instance of module \"%s\" (reason: %s)", module_name, err.what());
+      continue;
+    }
+
+    if (rebuilt.size() < static_cast<size_t>(instances)) {
+      m_log.err("Keeping running instance of module \"%s\"", module_name);
+      continue;
+    }
+
+    for (auto&& module : rebuilt) {
+      modules.emplace_back(move(module));
+    }
+
+    m_module_configs[module_name] = conf.get();
+  }
+
+  m_log.info("Reloaded config, restarting %lu module(s)", modules.size());
+  m_configs.emplace_back(move(conf));
+
+  // Configs no module was built from anymore are freed by the
+  // eventloop once it has stopped the replaced modules. The latest
+  // one is kept to compare against on the next change
+  vector<unique_ptr<config>> retired;
+
+  for (auto it = m_configs.begin(); it + 1 < m_configs.end();) {
+    auto used = [&](const pair<const string, const config*>& entry) { return entry.second == it->get(); };
+
+    if (std::none_of(m_module_configs.begin(), m_module_configs.end(), used)) {
+      retired.emplace_back(move(*it));
+      it = m_configs.erase(it);
+    } else {
+      it++;
+    }
+  }
+
+  if (!modules.empty() || !retired.empty()) {
+    m_eventloop->replace_modules(move(modules), move(retired));
+  }
+
+  return true;
+}
+
 /**
  * Callback for received ipc actions
  */
@@ -418,9 +591,7 @@ void controller::on_ipc_action(const ipc_action& message) {
 
   string action = message.payload.substr(strlen(ipc_action::prefix));
 
-  if (action.size() >= sizeof(input_event::data)) {
-    m_log.warn("Ignoring input event (size)");
-  } else if (action.empty()) {
+  if (action.empty()) {
     m_log.err("Cannot enqueue empty IPC action");
   } else {
     m_log.info("Enqueuing IPC action: %s", action);
@@ -434,8 +605,6 @@ void controller::on_ipc_action(const ipc_action& message) {
 void controller::on_mouse_event(const string& input) {
   if (!m_eventloop) {
     return;
-  } else if (input.length() >= sizeof(input_event::data)) {
-    m_log.warn("Ignoring input event (size)");
   } else if (!m_eventloop->enqueue_delayed(eventloop::make(input_event{}, input))) {
     m_log.trace_x("controller: Dispatcher busy");
   }
@@ -445,19 +614,14 @@ void controller::on_mouse_event(const string& input) {
  * Callback for actions not handled internally by a module
  */
 void controller::on_unrecognized_action(string input) {
-  try {
-    if (m_command) {
-      m_log.warn("Terminating previous shell command");
-      m_command->terminate();
-    }
+  if (!m_executor) {
+    return;
+  }
 
-    m_log.info("Executing shell command: %s", input);
+  m_log.info("Queuing shell command: %s", input);
 
-    m_command = command_util::make_command(input);
-    m_command->exec();
-    m_command.reset();
-  } catch (const application_error& err) {
-    m_log.err("controller: Error while forwarding input to shell -> %s", err.what());
+  if (!m_executor->exec(move(input))) {
+    m_log.err("controller: Error while forwarding input to shell");
   }
 }
 
@@ -472,6 +636,7 @@ void controller::on_update(bool force) {
   const bar_settings& bar{m_bar->settings()};
 
   string contents;
+  segmentmap_t segments;
   string separator{bar.separator};
 
   string padding_left(bar.padding.left, ' ');
@@ -480,8 +645,22 @@ void controller::on_update(bool force) {
   auto margin_left = bar.module_margin.left;
   auto margin_right = bar.module_margin.right;
 
+  auto compact = [](string data) {
+    // Strip unnecessary reset tags
+    data = string_util::replace_all(data, "T-}%{T", "T");
+    data = string_util::replace_all(data, "B-}%{B#", "B#");
+    data = string_util::replace_all(data, "F-}%{F#", "F#");
+    data = string_util::replace_all(data, "U-}%{U#", "U#");
+    data = string_util::replace_all(data, "u-}%{u#", "u#");
+    data = string_util::replace_all(data, "o-}%{o#", "o#");
+
+    // Join consecutive tags
+    return string_util::replace_all(data, "}%{", " ");
+  };
+
   for (const auto& block : m_eventloop->modules()) {
     string block_contents;
+    vector<string>& block_segments = segments[block.first];
     bool is_left = false;
     bool is_center = false;
     bool is_right = false;
@@ -496,26 +675,39 @@ void controller::on_update(bool force) {
 
     for (const auto& module : block.second) {
       auto module_contents = module->contents();
+      string segment;
 
-      if (module_contents.empty()) {
-        continue;
-      }
+      if (!module_contents.empty()) {
+        if (!block_contents.empty() && !separator.empty()) {
+          segment += separator;
+        }
 
-      if (!block_contents.empty() && !separator.empty()) {
-        block_contents += separator;
-      }
+        if (!(is_left && module == block.second.front())) {
+          segment += string(margin_left, ' ');
+        }
 
-      if (!(is_left && module == block.second.front())) {
-        block_contents += string(margin_left, ' ');
-      }
+        segment += module_contents;
 
-      block_contents += module->contents();
+        if (!(is_right && module == block.second.back())) {
+          segment += string(margin_right, ' ');
+        }
+
+        block_contents += segment;
+      }
 
-      if (!(is_right && module == block.second.back())) {
-        block_contents += string(margin_right, ' ');
+      // Keep one segment per module, even if it's empty,
+      // so that unchanged modules keep their position
+      if (m_incremental) {
+        block_segments.emplace_back(compact(move(segment)));
       }
     }
 
+    if (m_incremental && is_left) {
+      block_segments.emplace(block_segments.begin(), block_contents.empty() ? "" : padding_left);
+    } else if (m_incremental && is_right) {
+      block_segments.emplace_back(block_contents.empty() ? "" : padding_right);
+    }
+
     if (block_contents.empty()) {
       continue;
     }
@@ -530,16 +722,7 @@ void controller::on_update(bool force) {
       block_contents += padding_right;
     }
 
-    // Strip unnecessary reset tags
-    block_contents = string_util::replace_all(block_contents, "T-}%{T", "T");
-    block_contents = string_util::replace_all(block_contents, "B-}%{B#", "B#");
-    block_contents = string_util::replace_all(block_contents, "F-}%{F#", "F#");
-    block_contents = string_util::replace_all(block_contents, "U-}%{U#", "U#");
-    block_contents = string_util::replace_all(block_contents, "u-}%{u#", "u#");
-    block_contents = string_util::replace_all(block_contents, "o-}%{o#", "o#");
-
-    // Join consecutive tags
-    contents += string_util::replace_all(block_contents, "}%{", " ");
+    contents += compact(move(block_contents));
   }
 
   if (m_writeback) {
@@ -557,7 +740,11 @@ void controller::on_update(bool force) {
   }
 
   try {
-    m_bar->parse(contents, force);
+    if (m_incremental) {
+      m_bar->parse(segments, force);
+    } else {
+      m_bar->parse(contents, force);
+    }
   } catch (const exception& err) {
     m_log.err("Failed to update bar contents (reason: %s)", err.what());
   }
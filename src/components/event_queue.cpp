@@ -0,0 +1,85 @@
+#include "components/event_queue.hpp"
+
+POLYBAR_NS
+
+/**
+ * Get the priority lane of given event
+ */
+event_lane event_queue::lane_of(const event& evt) {
+  if (evt.type == static_cast<uint8_t>(event_type::INPUT) || evt.type == static_cast<uint8_t>(event_type::QUIT)) {
+    return event_lane::INPUT;
+  }
+  return event_lane::UPDATE;
+}
+
+/**
+ * Add event to its lane
+ */
+bool event_queue::enqueue(const event& evt) {
+  auto lane = static_cast<size_t>(lane_of(evt));
+
+  if (!m_lanes[lane].enqueue(evt)) {
+    return false;
+  }
+
+  size_t depth{++m_depth[lane]};
+  size_t depth_max{m_depth_max[lane].load()};
+
+  while (depth > depth_max && !m_depth_max[lane].compare_exchange_weak(depth_max, depth)) {
+  }
+
+  m_pending.signal();
+  return true;
+}
+
+/**
+ * Wait for the next event, taking it from the highest priority lane
+ */
+void event_queue::dequeue(event& evt) {
+  m_pending.wait();
+  take(evt);
+}
+
+/**
+ * Wait for the next event until timeout
+ */
+bool event_queue::dequeue(event& evt, chrono::steady_clock::duration timeout) {
+  if (!m_pending.wait(chrono::duration_cast<chrono::microseconds>(timeout).count())) {
+    return false;
+  }
+  take(evt);
+  return true;
+}
+
+/**
+ * Get the number of events waiting in given lane
+ */
+size_t event_queue::depth(event_lane lane) const {
+  return m_depth[static_cast<size_t>(lane)];
+}
+
+/**
+ * Get the highest number of events that waited in given lane
+ */
+size_t event_queue::max_depth(event_lane lane) const {
+  return m_depth_max[static_cast<size_t>(lane)];
+}
+
+/**
+ * Take event accounted for by the semaphore
+ *
+ * Events are enqueued before the semaphore is signaled,
+ * so one of the lanes is guaranteed to hold an event
+ */
+void event_queue::take(event& evt) {
+  while (true) {
+    for (size_t lane = 0; lane < m_lanes.size(); lane++) {
+      if (m_lanes[lane].try_dequeue(evt)) {
+        m_depth[lane]--;
+        return;
+      }
+    }
+  }
+}
+
+POLYBAR_NS_END
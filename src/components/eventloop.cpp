@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <csignal>
 
 #include "components/eventloop.hpp"
@@ -9,13 +10,20 @@
 
 POLYBAR_NS
 
+event_payloads eventloop::s_payloads;
+
 /**
  * Construct eventloop instance
  */
 eventloop::eventloop(const logger& logger, const config& config) : m_log(logger), m_conf(config) {
   m_delayed_time = duration_t{m_conf.get<double>("settings", "eventloop-delayed-time", 25)};
-  m_swallow_time = duration_t{m_conf.get<double>("settings", "eventloop-swallow-time", 10)};
-  m_swallow_limit = m_conf.get<size_t>("settings", "eventloop-swallow", 5U);
+  m_frame_interval = duration_t{m_conf.get<double>("settings", "eventloop-frame-interval", 16)};
+  m_input_latency = duration_t{m_conf.get<double>("settings", "eventloop-input-latency", 10)};
+
+  if (m_conf.get<bool>("settings", "eventloop-reactor", false)) {
+    m_reactor = make_unique<reactor>(m_log, duration_t{m_conf.get<double>("settings", "eventloop-timer-slack", 20)});
+    m_reactor->set_batch_cb(bind(&eventloop::batch_updates, this, placeholders::_1));
+  }
 
   g_signals::event::enqueue = bind(&eventloop::enqueue, this, placeholders::_1);
   g_signals::event::enqueue_delayed = bind(&eventloop::enqueue_delayed, this, placeholders::_1);
@@ -31,6 +39,19 @@ eventloop::~eventloop() {
   m_update_cb = nullptr;
   m_unrecognized_input_cb = nullptr;
 
+  if (m_frames) {
+    m_log.info("eventloop: Drew %lu frame(s) for %lu broadcast(s), latency avg %.2f ms, max %.2f ms", m_frames,
+        m_broadcasts, m_latency_total.count() / m_frames, m_latency_max.count());
+  }
+
+  if (m_inputs) {
+    m_log.info("eventloop: Handled %lu input(s), %lu late, queueing delay max %.2f ms", m_inputs, m_inputs_late,
+        m_input_delay_max.count());
+  }
+
+  m_log.info("eventloop: Max queue depth input=%lu update=%lu", m_queue.max_depth(event_lane::INPUT),
+      m_queue.max_depth(event_lane::UPDATE));
+
   if (m_delayed_thread.joinable()) {
     m_delayed_thread.join();
   }
@@ -38,6 +59,11 @@ eventloop::~eventloop() {
     m_queue_thread.join();
   }
 
+  // Stop dispatching before the modules go away
+  if (m_reactor) {
+    m_reactor->stop();
+  }
+
   for (auto&& block : m_modules) {
     for (auto&& module : block.second) {
       auto module_name = module->name();
@@ -48,6 +74,9 @@ eventloop::~eventloop() {
       m_log.trace("eventloop: Deconstruction of %s took %lu microsec.", module_name, cleanup_ms);
     }
   }
+
+  // Drop the data of inputs left in the queue
+  s_payloads.clear();
 }
 
 /**
@@ -59,6 +88,10 @@ void eventloop::start() {
 
   dispatch_modules();
 
+  if (m_reactor) {
+    m_reactor->start();
+  }
+
   m_queue_thread = thread(&eventloop::dispatch_queue_worker, this);
   m_delayed_thread = thread(&eventloop::dispatch_delayed_worker, this);
 }
@@ -94,6 +127,7 @@ bool eventloop::enqueue(const entry_t& entry) {
     return true;
   }
   m_log.warn("Failed to enqueue event (%d)", entry.type);
+  discard_event(entry);
   return false;
 }
 
@@ -102,18 +136,22 @@ bool eventloop::enqueue(const entry_t& entry) {
  */
 bool eventloop::enqueue_delayed(const entry_t& entry) {
   if (!m_delayed_lock.try_lock()) {
+    discard_event(entry);
     return false;
   }
 
   std::unique_lock<std::mutex> guard(m_delayed_lock, std::adopt_lock);
 
   if (m_delayed_entry.type != 0) {
+    discard_event(entry);
     return false;
   }
 
+  // The payload is taken once the event is dispatched
   m_delayed_entry = entry;
+  m_delayed_data = match_event(entry, event_type::INPUT) ? s_payloads.data(entry.payload) : string{};
 
-  if (m_queue.enqueue(entry)) {
+  if (enqueue(entry)) {
     return true;
   }
 
@@ -121,6 +159,46 @@ bool eventloop::enqueue_delayed(const entry_t& entry) {
   return false;
 }
 
+/**
+ * Add module to the set of modules needing a redraw
+ *
+ * Only the first broadcast since the last redraw enqueues an
+ * UPDATE event, later ones are coalesced into the same frame
+ */
+void eventloop::mark_dirty(const modules::module_interface* module) {
+  std::lock_guard<std::mutex> guard(m_dirty_lock);
+
+  m_broadcasts++;
+
+  if (m_dirty.empty()) {
+    m_dirty_time = chrono::steady_clock::now();
+  }
+
+  if (std::find(m_dirty.begin(), m_dirty.end(), module) == m_dirty.end()) {
+    m_dirty.emplace_back(module);
+  }
+
+  if (m_update_pending || m_batching) {
+    return;
+  }
+
+  m_update_pending = enqueue({static_cast<uint8_t>(event_type::UPDATE)});
+}
+
+/**
+ * Hold back UPDATE events while a batch of module
+ * handlers is running, and schedule a single one after it
+ */
+void eventloop::batch_updates(bool state) {
+  std::lock_guard<std::mutex> guard(m_dirty_lock);
+
+  m_batching = state;
+
+  if (!m_batching && !m_update_pending && !m_dirty.empty()) {
+    m_update_pending = enqueue({static_cast<uint8_t>(event_type::UPDATE)});
+  }
+}
+
 /**
  * Set callback handler for UPDATE events
  */
@@ -139,6 +217,8 @@ void eventloop::set_input_db(callback<string>&& cb) {
  * Add module to alignment block
  */
 void eventloop::add_module(const alignment pos, module_t&& module) {
+  module->set_reactor(m_reactor.get());
+
   auto it = m_modules.lower_bound(pos);
 
   if (it != m_modules.end() && !(m_modules.key_comp()(pos, it->first))) {
@@ -150,6 +230,35 @@ void eventloop::add_module(const alignment pos, module_t&& module) {
   }
 }
 
+/**
+ * Queue modules to replace the running modules with the same
+ * name. The swap is done by the queue worker, so that the module
+ * map isn't modified while it's being used for a redraw
+ *
+ * Replacements still pending from an earlier call are dropped
+ * in favour of the new instances. The retired configs are freed
+ * once the replaced modules have been stopped
+ */
+void eventloop::replace_modules(vector<module_t>&& modules, vector<unique_ptr<config>>&& retired) {
+  {
+    std::lock_guard<std::mutex> guard(m_replace_lock);
+
+    for (auto&& module : modules) {
+      auto superseded = [&](const module_t& pending) { return pending->name() == module->name(); };
+      m_replacements.erase(
+          std::remove_if(m_replacements.begin(), m_replacements.end(), superseded), m_replacements.end());
+    }
+    for (auto&& module : modules) {
+      m_replacements.emplace_back(forward<module_t>(module));
+    }
+    for (auto&& conf : retired) {
+      m_retired.emplace_back(forward<unique_ptr<config>>(conf));
+    }
+  }
+
+  enqueue({static_cast<uint8_t>(event_type::RELOAD)});
+}
+
 /**
  * Get reference to module map
  */
@@ -189,32 +298,20 @@ void eventloop::dispatch_modules() {
  */
 void eventloop::dispatch_queue_worker() {
   while (m_running) {
-    entry_t evt, next{static_cast<uint8_t>(event_type::NONE)};
-    m_queue.wait_dequeue(evt);
+    entry_t evt;
+    dequeue(evt);
 
     if (!m_running) {
       break;
     }
 
-    if (m_delayed_entry.type != 0 && compare_events(evt, m_delayed_entry)) {
-      m_delayed_cond.notify_one();
+    if (match_event(evt, event_type::UPDATE)) {
+      wait_frame(evt);
     }
 
-    size_t swallowed{0};
-    while (swallowed++ < m_swallow_limit && m_queue.wait_dequeue_timed(next, m_swallow_time)) {
-      if (match_event(next, event_type::QUIT)) {
-        evt = next;
-        break;
-      } else if (!compare_events(evt, next)) {
-        enqueue(move(next));
-        break;
-      }
-
-      m_log.trace_x("eventloop: Swallowing event within timeframe");
-      evt = next;
+    if (m_running) {
+      forward_event(evt);
     }
-
-    forward_event(evt);
   }
 
   m_log.info("Queue worker done");
@@ -242,6 +339,36 @@ void eventloop::dispatch_delayed_worker() {
   m_log.info("Delayed worker done");
 }
 
+/**
+ * Wait for the next event
+ */
+void eventloop::dequeue(entry_t& evt) {
+  m_queue.dequeue(evt);
+  m_log.trace_x("eventloop: Dequeued event (%d), queue depth input=%lu update=%lu", evt.type,
+      m_queue.depth(event_lane::INPUT), m_queue.depth(event_lane::UPDATE));
+}
+
+/**
+ * Wait for the next event until timeout
+ */
+bool eventloop::dequeue_timed(entry_t& evt, chrono::steady_clock::duration timeout) {
+  if (!m_queue.dequeue(evt, timeout)) {
+    return false;
+  }
+  m_log.trace_x("eventloop: Dequeued event (%d), queue depth input=%lu update=%lu", evt.type,
+      m_queue.depth(event_lane::INPUT), m_queue.depth(event_lane::UPDATE));
+  return true;
+}
+
+/**
+ * Release the payload of an event that won't be dispatched
+ */
+void eventloop::discard_event(const entry_t& evt) {
+  if (match_event(evt, event_type::INPUT)) {
+    s_payloads.take(evt.payload);
+  }
+}
+
 /**
  * Test if event matches given type
  */
@@ -250,13 +377,16 @@ inline bool eventloop::match_event(entry_t evt, event_type type) {
 }
 
 /**
- * Compare given events
+ * Compare given event with the delayed one
+ *
+ * The slot of the delayed payload may have been
+ * reused, so a copy of its data is compared
  */
-inline bool eventloop::compare_events(entry_t evt, entry_t evt2) {
-  if (evt.type != evt2.type) {
+inline bool eventloop::compare_delayed(entry_t evt) {
+  if (evt.type != m_delayed_entry.type) {
     return false;
   } else if (match_event(evt, event_type::INPUT)) {
-    return evt.data[0] == evt2.data[0] && strncmp(evt.data, evt2.data, strlen(evt.data)) == 0;
+    return s_payloads.equal(evt.payload, m_delayed_data);
   }
 
   return true;
@@ -266,30 +396,94 @@ inline bool eventloop::compare_events(entry_t evt, entry_t evt2) {
  * Forward event to handler based on type
  */
 void eventloop::forward_event(entry_t evt) {
+  {
+    std::lock_guard<std::mutex> guard(m_delayed_lock);
+
+    if (m_delayed_entry.type != 0 && compare_delayed(evt)) {
+      m_delayed_cond.notify_one();
+    }
+  }
+
   if (evt.type == static_cast<uint8_t>(event_type::UPDATE)) {
-    on_update(reinterpret_cast<const update_event&>(evt));
+    on_update(update_event{evt.flag});
   } else if (evt.type == static_cast<uint8_t>(event_type::INPUT)) {
-    on_input(reinterpret_cast<const input_event&>(evt));
+    on_input(s_payloads.take(evt.payload));
   } else if (evt.type == static_cast<uint8_t>(event_type::CHECK)) {
     on_check();
   } else if (evt.type == static_cast<uint8_t>(event_type::QUIT)) {
-    on_quit(reinterpret_cast<const quit_event&>(evt));
+    on_quit(quit_event{evt.flag});
+  } else if (evt.type == static_cast<uint8_t>(event_type::RELOAD)) {
+    on_reload();
   } else {
     m_log.warn("Unknown event type for enqueued event (%d)", evt.type);
   }
 }
 
+/**
+ * Hold back an UPDATE event until the frame interval has passed
+ * since the last redraw. Other events are handled in the meantime
+ * and further UPDATE events are merged into the pending one
+ *
+ * The wait is cut short when an input was received since the
+ * last redraw, so that its result is drawn within the latency bound
+ */
+void eventloop::wait_frame(entry_t& evt) {
+  entry_t next{static_cast<uint8_t>(event_type::NONE)};
+
+  auto frame_interval = chrono::duration_cast<chrono::steady_clock::duration>(m_frame_interval);
+  auto input_latency = chrono::duration_cast<chrono::steady_clock::duration>(m_input_latency);
+
+  while (m_running) {
+    auto now = chrono::steady_clock::now();
+    auto deadline = m_frame_time + frame_interval;
+
+    if (input_latency.count() > 0 && m_input_time > m_frame_time) {
+      deadline = std::min(deadline, m_input_time + input_latency);
+    }
+
+    if (now >= deadline || !dequeue_timed(next, deadline - now)) {
+      break;
+    } else if (match_event(next, event_type::UPDATE)) {
+      m_log.trace_x("eventloop: Merging UPDATE event into pending frame");
+      evt.flag = evt.flag || next.flag;
+    } else {
+      forward_event(next);
+    }
+  }
+}
+
 /**
  * Handler for enqueued UPDATE events
  */
 void eventloop::on_update(const update_event& evt) {
   m_log.trace("eventloop: Received UPDATE event");
 
+  size_t dirty;
+  chrono::steady_clock::time_point dirty_time;
+
+  {
+    std::lock_guard<std::mutex> guard(m_dirty_lock);
+    dirty = m_dirty.size();
+    dirty_time = m_dirty_time;
+    m_dirty.clear();
+    m_update_pending = false;
+  }
+
   if (m_update_cb) {
     m_update_cb(evt.force);
   } else {
     m_log.warn("No callback to handle update");
   }
+
+  m_frame_time = chrono::steady_clock::now();
+
+  if (dirty) {
+    duration_t latency{m_frame_time - dirty_time};
+    m_frames++;
+    m_latency_total += latency;
+    m_latency_max = std::max(m_latency_max, latency);
+    m_log.trace("eventloop: Redrew %lu dirty module(s), %.2f ms after broadcast", dirty, latency.count());
+  }
 }
 
 /**
@@ -298,6 +492,17 @@ void eventloop::on_update(const update_event& evt) {
 void eventloop::on_input(const input_event& evt) {
   m_log.trace("eventloop: Received INPUT event");
 
+  duration_t delay{chrono::steady_clock::now() - evt.time};
+
+  m_inputs++;
+  m_input_time = evt.time;
+  m_input_delay_max = std::max(m_input_delay_max, delay);
+
+  if (m_input_latency.count() > 0 && delay > m_input_latency) {
+    m_inputs_late++;
+    m_log.warn("eventloop: Input handled %.2f ms after it was received", delay.count());
+  }
+
   for (auto&& block : m_modules) {
     for (auto&& module : block.second) {
       if (!module->receive_events()) {
@@ -345,4 +550,71 @@ void eventloop::on_quit(const quit_event& evt) {
   }
 }
 
+/**
+ * Handler for enqueued RELOAD events
+ *
+ * Stops the modules that have been rebuilt and
+ * starts the new instances in their place
+ */
+void eventloop::on_reload() {
+  // Declared first to outlive the modules built from them
+  vector<unique_ptr<config>> retired;
+  vector<module_t> replacements;
+  {
+    std::lock_guard<std::mutex> guard(m_replace_lock);
+    replacements.swap(m_replacements);
+    retired.swap(m_retired);
+  }
+
+  if (replacements.empty()) {
+    return;
+  }
+
+  // Instances listed in several places are replaced one by one
+  vector<const modules::module_interface*> started;
+
+  for (auto&& replacement : replacements) {
+    module_t* slot{nullptr};
+
+    for (auto&& block : m_modules) {
+      for (auto&& module : block.second) {
+        if (slot == nullptr && module->name() == replacement->name() &&
+            std::find(started.begin(), started.end(), module.get()) == started.end()) {
+          slot = &module;
+        }
+      }
+    }
+
+    if (slot == nullptr) {
+      m_log.warn("eventloop: No running module named %s to replace", replacement->name());
+      continue;
+    }
+
+    m_log.info("Restarting %s", replacement->name());
+
+    module_t previous{move(*slot)};
+    previous->stop();
+
+    {
+      std::lock_guard<std::mutex> guard(m_dirty_lock);
+      m_dirty.erase(std::remove(m_dirty.begin(), m_dirty.end(), previous.get()), m_dirty.end());
+    }
+
+    previous.reset();
+
+    replacement->set_reactor(m_reactor.get());
+    started.emplace_back(replacement.get());
+    *slot = move(replacement);
+
+    try {
+      (*slot)->start();
+    } catch (const application_error& err) {
+      m_log.err("Failed to start '%s' (reason: %s)", (*slot)->name(), err.what());
+    }
+  }
+
+  // Redraw in case a module went away without broadcasting
+  enqueue(make(update_event{}, true));
+}
+
 POLYBAR_NS_END
@@ -0,0 +1,289 @@
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <csignal>
+
+#include "components/executor.hpp"
+#include "errors.hpp"
+#include "utils/io.hpp"
+#include "utils/process.hpp"
+#include "utils/string.hpp"
+
+POLYBAR_NS
+
+/**
+ * Construct executor instance
+ *
+ * SIGCHLD has to be blocked in all threads
+ * for it to be delivered through the signalfd
+ */
+executor::executor(const logger& logger, size_t max_running, size_t max_pending, duration_t timeout)
+    : m_log(logger), m_max_running(max_running), m_max_pending(max_pending), m_timeout(timeout) {
+  sigset_t mask;
+  sigemptyset(&mask);
+  sigaddset(&mask, SIGCHLD);
+
+  if (pthread_sigmask(SIG_BLOCK, &mask, nullptr) == -1) {
+    throw system_error("Failed to block SIGCHLD");
+  }
+  if ((m_signalfd = signalfd(-1, &mask, SFD_CLOEXEC | SFD_NONBLOCK)) == -1) {
+    throw system_error("Failed to create signalfd");
+  }
+  if ((m_wakeupfd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)) == -1) {
+    close(m_signalfd);
+    throw system_error("Failed to create wakeup eventfd");
+  }
+
+  if (m_max_running == 0) {
+    m_max_running = 1;
+  }
+}
+
+/**
+ * Deconstruct executor and terminate running commands
+ */
+executor::~executor() {
+  stop();
+
+  if (!m_running.empty()) {
+    m_log.info("executor: Terminating %lu running command(s)", m_running.size());
+    m_running.clear();
+  }
+
+  close(m_wakeupfd);
+  close(m_signalfd);
+}
+
+/**
+ * Start dispatch thread
+ */
+void executor::start() {
+  if (m_active.exchange(true)) {
+    return;
+  }
+  m_log.trace("executor: Starting dispatch thread");
+  m_thread = thread(&executor::dispatch, this);
+}
+
+/**
+ * Stop dispatch thread and wait for it to finish
+ */
+void executor::stop() {
+  if (!m_active.exchange(false)) {
+    return;
+  }
+  wakeup();
+  if (m_thread.joinable()) {
+    m_thread.join();
+  }
+}
+
+/**
+ * Queue command using the default timeout
+ */
+bool executor::exec(string cmd) {
+  return exec(move(cmd), m_timeout);
+}
+
+/**
+ * Queue command to be run in the background
+ */
+bool executor::exec(string cmd, duration_t timeout) {
+  {
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    if (m_pending.size() >= m_max_pending) {
+      m_log.warn("executor: Too many pending commands, dropping \"%s\"", cmd);
+      return false;
+    }
+
+    m_pending.emplace_back(pending_job{move(cmd), timeout});
+  }
+
+  wakeup();
+  return true;
+}
+
+/**
+ * Dispatch thread
+ */
+void executor::dispatch() {
+  vector<struct pollfd> fds;
+  vector<job*> readers;
+
+  while (m_active) {
+    spawn_pending();
+
+    fds.clear();
+    readers.clear();
+    fds.push_back({m_wakeupfd, POLLIN, 0});
+    fds.push_back({m_signalfd, POLLIN, 0});
+
+    for (auto&& j : m_running) {
+      if (j->output_open) {
+        fds.push_back({j->command->get_stdout(PIPE_READ), POLLIN, 0});
+        readers.emplace_back(j.get());
+      }
+    }
+
+    if (poll(fds.data(), fds.size(), next_timeout()) == -1 && errno != EINTR) {
+      m_log.err("executor: Failed to poll (%s)", strerror(errno));
+      break;
+    }
+
+    if (fds[0].revents & POLLIN) {
+      eventfd_t value;
+      eventfd_read(m_wakeupfd, &value);
+    }
+
+    if (fds[1].revents & POLLIN) {
+      struct signalfd_siginfo info;
+      while (read(m_signalfd, &info, sizeof(info)) == sizeof(info)) {
+      }
+    }
+
+    for (size_t i = 0; i < readers.size(); i++) {
+      if (fds[i + 2].revents & (POLLIN | POLLHUP)) {
+        read_output(*readers[i]);
+      }
+    }
+
+    reap();
+    expire();
+  }
+
+  m_log.trace("executor: Dispatch thread done");
+}
+
+/**
+ * Start queued commands while there are free slots
+ */
+void executor::spawn_pending() {
+  while (m_running.size() < m_max_running) {
+    pending_job pending;
+    {
+      std::lock_guard<std::mutex> guard(m_lock);
+      if (m_pending.empty()) {
+        break;
+      }
+      pending = move(m_pending.front());
+      m_pending.pop_front();
+    }
+
+    unique_ptr<job> j{new job{}};
+    j->cmd = move(pending.cmd);
+
+    if (pending.timeout.count() > 0) {
+      j->deadline = clock_t::now() + chrono::duration_cast<clock_t::duration>(pending.timeout);
+    } else {
+      j->deadline = clock_t::time_point::max();
+    }
+
+    try {
+      j->command = command_util::make_command(j->cmd);
+      j->command->exec(false);
+    } catch (const application_error& err) {
+      m_log.err("executor: Failed to execute \"%s\" (%s)", j->cmd, err.what());
+      continue;
+    }
+
+    m_log.info("executor: Executing \"%s\" (pid=%d, running=%lu)", j->cmd, j->command->get_pid(),
+        m_running.size() + 1);
+    m_running.emplace_back(move(j));
+  }
+}
+
+/**
+ * Consume command output so the child never blocks on a full pipe
+ */
+void executor::read_output(job& j) {
+  char buffer[BUFSIZ];
+  ssize_t bytes{read(j.command->get_stdout(PIPE_READ), buffer, sizeof(buffer))};
+
+  if (bytes <= 0) {
+    j.output_open = false;
+  } else {
+    m_log.trace_x("executor: \"%s\" > %s", j.cmd, string_util::trim(string{buffer, static_cast<size_t>(bytes)}, '\n'));
+  }
+}
+
+/**
+ * Collect the status of finished commands
+ */
+void executor::reap() {
+  for (auto it = m_running.begin(); it != m_running.end();) {
+    auto& j = *it;
+    int status{0};
+    pid_t pid{process_util::wait_for_completion_nohang(j->command->get_pid(), &status)};
+
+    if (pid == 0) {
+      it++;
+      continue;
+    }
+
+    if (pid > 0 && WIFEXITED(status) && WEXITSTATUS(status) != 0) {
+      m_log.warn("executor: \"%s\" exited with status %d", j->cmd, WEXITSTATUS(status));
+    } else if (pid > 0 && WIFSIGNALED(status)) {
+      m_log.trace("executor: \"%s\" killed by signal %d", j->cmd, WTERMSIG(status));
+    } else {
+      m_log.trace("executor: \"%s\" finished", j->cmd);
+    }
+
+    it = m_running.erase(it);
+  }
+}
+
+/**
+ * Terminate commands running past their deadline, sending
+ * SIGKILL if they are still around after a grace period
+ */
+void executor::expire() {
+  auto now = clock_t::now();
+
+  for (auto&& j : m_running) {
+    if (now < j->deadline) {
+      continue;
+    } else if (!j->terminated) {
+      m_log.warn("executor: Terminating \"%s\" (timeout)", j->cmd);
+      killpg(j->command->get_pid(), SIGTERM);
+      j->terminated = true;
+      j->deadline = now + chrono::seconds{1};
+    } else {
+      m_log.warn("executor: Killing \"%s\"", j->cmd);
+      killpg(j->command->get_pid(), SIGKILL);
+      j->deadline = clock_t::time_point::max();
+    }
+  }
+}
+
+/**
+ * Get the number of milliseconds to wait before
+ * the next deadline or status poll
+ */
+int executor::next_timeout() const {
+  if (m_running.empty()) {
+    return -1;
+  }
+
+  // Poll the children once in a while in case
+  // SIGCHLD was consumed by someone else
+  auto timeout = clock_t::now() + chrono::seconds{1};
+
+  for (auto&& j : m_running) {
+    timeout = std::min(timeout, j->deadline);
+  }
+
+  auto ms = chrono::duration_cast<chrono::milliseconds>(timeout - clock_t::now()).count();
+  return ms > 0 ? static_cast<int>(ms) : 0;
+}
+
+/**
+ * Interrupt a pending poll call
+ */
+void executor::wakeup() {
+  eventfd_write(m_wakeupfd, 1);
+}
+
+POLYBAR_NS_END
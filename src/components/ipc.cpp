@@ -63,7 +63,12 @@ void ipc::receive_messages() {
   m_log.info("Listening for ipc messages on: %s", m_fifo);
 
   while ((m_fd = open(m_fifo.c_str(), O_RDONLY)) != -1 && m_running) {
-    parse(io_util::readline(m_fd));
+    // Handle every message written before the writer closed the channel
+    io_util::line_reader reader{m_fd};
+    string payload;
+    while (m_running && reader.readline(payload)) {
+      parse(payload);
+    }
     close(m_fd);
   }
 }
@@ -1,52 +1,41 @@
-#include <cassert>
-
 #include "components/logger.hpp"
 #include "components/parser.hpp"
-#include "components/signals.hpp"
 #include "components/types.hpp"
-#include "utils/math.hpp"
-#include "utils/string.hpp"
+#include "utils/color.hpp"
 
 POLYBAR_NS
 
 /**
  * Construct parser instance
  */
-parser::parser(const logger& logger, const bar_settings& bar) : m_log(logger), m_bar(bar) {
-  assert(g_signals::parser::background_change != nullptr);
-  assert(g_signals::parser::foreground_change != nullptr);
-  assert(g_signals::parser::underline_change != nullptr);
-  assert(g_signals::parser::overline_change != nullptr);
-  assert(g_signals::parser::alignment_change != nullptr);
-  assert(g_signals::parser::attribute_set != nullptr);
-  assert(g_signals::parser::attribute_unset != nullptr);
-  assert(g_signals::parser::attribute_toggle != nullptr);
-  assert(g_signals::parser::font_change != nullptr);
-  assert(g_signals::parser::pixel_offset != nullptr);
-  assert(g_signals::parser::action_block_open != nullptr);
-  assert(g_signals::parser::action_block_close != nullptr);
-  assert(g_signals::parser::ascii_text_write != nullptr);
-  assert(g_signals::parser::unicode_text_write != nullptr);
-  assert(g_signals::parser::string_write != nullptr);
-}
+parser::parser(const logger& logger, const bar_settings& bar) : m_log(logger), m_bar(bar) {}
 
 /**
- * Process input string
+ * Compile input string into a list of draw operations
+ *
+ * The input is tokenized in a single pass without copying
+ * any part of it. The output list is cleared but keeps its
+ * storage, so reusing it between calls avoids allocations
  */
-void parser::operator()(string data) {
-  size_t pos;
+void parser::operator()(string_view data, drawlist& output) {
+  m_log.trace_x("parser: Compiling %lu bytes", data.size());
 
-  m_log.trace_x("parser: %s", data);
+  m_output = &output;
+  m_output->clear();
+  m_actions.clear();
 
-  while (data.length()) {
-    if (data.compare(0, 2, "%{") == 0 && (pos = data.find('}')) != string::npos) {
+  while (!data.empty()) {
+    size_t pos;
+
+    if (!data.starts_with("%{")) {
+      pos = data.find("%{");
+      data.remove_prefix(text(data.substr(0, pos)));
+    } else if ((pos = data.find('}')) != string_view::npos) {
       codeblock(data.substr(2, pos - 2));
-      data.erase(0, pos + 1);
+      data.remove_prefix(pos + 1);
     } else {
-      if ((pos = data.find("%{")) == string::npos) {
-        pos = data.length();
-      }
-      data.erase(0, text(data.substr(0, pos)));
+      // Unterminated tags are treated as regular text
+      data.remove_prefix(text(data));
     }
   }
 
@@ -58,102 +47,97 @@ void parser::operator()(string data) {
 /**
  * Process contents within tag blocks, i.e: %{...}
  */
-void parser::codeblock(string data) {
+void parser::codeblock(string_view data) {
   size_t pos;
 
-  while (data.length()) {
-    data = string_util::ltrim(data, ' ');
-
-    if (data.empty()) {
-      break;
-    }
+  while ((pos = data.find_first_not_of(' ')) != string_view::npos) {
+    data.remove_prefix(pos);
 
     char tag{data[0]};
-    string value;
+    data.remove_prefix(1);
 
-    // Remove the tag
-    data.erase(0, 1);
-
-    if ((pos = data.find_first_of(" }")) != string::npos) {
-      value = data.substr(0, pos);
-    } else {
-      value = data;
-    }
+    string_view value{data.substr(0, data.find(' '))};
 
     switch (tag) {
       case 'B':
-        g_signals::parser::background_change(parse_color(value, m_bar.background));
+        emit(drawop_type::BACKGROUND, parse_color(value, m_bar.background));
         break;
 
       case 'F':
-        g_signals::parser::foreground_change(parse_color(value, m_bar.foreground));
+        emit(drawop_type::FOREGROUND, parse_color(value, m_bar.foreground));
         break;
 
       case 'T':
-        g_signals::parser::font_change(parse_fontindex(value));
+        emit(drawop_type::FONT, parse_fontindex(value));
         break;
 
       case 'U':
-        g_signals::parser::underline_change(parse_color(value, m_bar.underline.color));
-        g_signals::parser::overline_change(parse_color(value, m_bar.overline.color));
+        emit(drawop_type::UNDERLINE, parse_color(value, m_bar.underline.color));
+        emit(drawop_type::OVERLINE, parse_color(value, m_bar.overline.color));
         break;
 
       case 'u':
-        g_signals::parser::underline_change(parse_color(value, m_bar.underline.color));
+        emit(drawop_type::UNDERLINE, parse_color(value, m_bar.underline.color));
         break;
 
       case 'o':
-        g_signals::parser::overline_change(parse_color(value, m_bar.overline.color));
+        emit(drawop_type::OVERLINE, parse_color(value, m_bar.overline.color));
         break;
 
       case 'R':
-        g_signals::parser::background_change(m_bar.foreground);
-        g_signals::parser::foreground_change(m_bar.background);
+        emit(drawop_type::BACKGROUND, m_bar.foreground);
+        emit(drawop_type::FOREGROUND, m_bar.background);
         break;
 
       case 'O':
-        g_signals::parser::pixel_offset(atoi(value.c_str()));
+        emit(drawop_type::OFFSET, parse_integer(value));
         break;
 
       case 'l':
-        g_signals::parser::alignment_change(alignment::LEFT);
+        emit(drawop_type::ALIGNMENT, static_cast<int32_t>(alignment::LEFT));
         break;
 
       case 'c':
-        g_signals::parser::alignment_change(alignment::CENTER);
+        emit(drawop_type::ALIGNMENT, static_cast<int32_t>(alignment::CENTER));
         break;
 
       case 'r':
-        g_signals::parser::alignment_change(alignment::RIGHT);
+        emit(drawop_type::ALIGNMENT, static_cast<int32_t>(alignment::RIGHT));
         break;
 
       case '+':
-        g_signals::parser::attribute_set(parse_attr(value[0]));
+        emit(drawop_type::ATTRIBUTE_SET, static_cast<int32_t>(parse_attr(value.empty() ? '\0' : value[0])));
         break;
 
       case '-':
-        g_signals::parser::attribute_unset(parse_attr(value[0]));
+        emit(drawop_type::ATTRIBUTE_UNSET, static_cast<int32_t>(parse_attr(value.empty() ? '\0' : value[0])));
         break;
 
       case '!':
-        g_signals::parser::attribute_toggle(parse_attr(value[0]));
+        emit(drawop_type::ATTRIBUTE_TOGGLE, static_cast<int32_t>(parse_attr(value.empty() ? '\0' : value[0])));
+        break;
+
+      case 'G':
+        emit(drawop_type::GRAPH, parse_integer(value));
+        parse_samples(value.substr(std::min(value.find(':'), value.size())));
         break;
 
       case 'A':
-        if (isdigit(data[0]) || data[0] == ':') {
-          value = parse_action_cmd(data);
-          mousebtn btn = parse_action_btn(data);
-          m_actions.push_back(static_cast<int>(btn));
+        if (!data.empty() && (isdigit(data[0]) || data[0] == ':')) {
+          string_view cmd;
+          mousebtn btn{parse_action_btn(data)};
 
-          g_signals::parser::action_block_open(btn, value);
+          // The command may contain spaces, so the token
+          // ends at the colon closing the command
+          value = data.substr(0, parse_action_cmd(data, cmd));
+          m_actions.push_back(static_cast<int>(btn));
 
-          // make sure we strip the correct length (btn+wrapping colons)
-          if (value[0] != ':') {
-            value += "0";
-          }
-          value += "::";
+          emit(drawop_type::ACTION_OPEN, static_cast<int32_t>(btn));
+          m_output->ops.back().offset = m_output->commands.size();
+          m_output->ops.back().length = cmd.size();
+          m_output->commands.append(cmd.data(), cmd.size());
         } else if (!m_actions.empty()) {
-          g_signals::parser::action_block_close(parse_action_btn(value));
+          emit(drawop_type::ACTION_CLOSE, static_cast<int32_t>(parse_action_btn(value)));
           m_actions.pop_back();
         }
         break;
@@ -162,75 +146,149 @@ void parser::codeblock(string data) {
         throw unrecognized_token("Unrecognized token '" + string{tag} + "'");
     }
 
-    if (!data.empty()) {
-      data.erase(0, !value.empty() ? value.length() : 1);
-    }
+    data.remove_prefix(value.size());
   }
 }
 
 /**
  * Process text contents
+ *
+ * Decodes the utf-8 sequences of the given text and appends the
+ * characters to the current text run. Returns the number of bytes consumed
  */
-size_t parser::text(string data) {
-  uint8_t* utf = (uint8_t*)data.c_str();
-
-  if (utf[0] < 0x80) {
-    // grab all consecutive ascii chars
-    size_t next_tag = data.find("%{");
-    if (next_tag != string::npos) {
-      data.erase(next_tag);
-    }
-    size_t n = 0;
-    while (utf[n] != '\0' && utf[++n] < 0x80) {
-      ;
+size_t parser::text(string_view data) {
+  const uint8_t* utf{reinterpret_cast<const uint8_t*>(data.data())};
+  const size_t len{data.size()};
+  size_t n{0};
+
+  if (m_output->ops.empty() || m_output->ops.back().type != drawop_type::TEXT) {
+    emit(drawop_type::TEXT);
+    m_output->ops.back().offset = m_output->text.size();
+  }
+
+  auto& run = m_output->text;
+  auto& op = m_output->ops.back();
+
+  while (n < len) {
+    if (utf[n] < 0x80) {
+      run.emplace_back(utf[n]);
+      n += 1;
+    } else if ((utf[n] & 0xe0) == 0xc0 && n + 1 < len) {  // 2 byte utf-8 sequence
+      run.emplace_back((utf[n] & 0x1f) << 6 | (utf[n + 1] & 0x3f));
+      n += 2;
+    } else if ((utf[n] & 0xf0) == 0xe0 && n + 2 < len) {  // 3 byte utf-8 sequence
+      run.emplace_back((utf[n] & 0xf) << 12 | (utf[n + 1] & 0x3f) << 6 | (utf[n + 2] & 0x3f));
+      n += 3;
+    } else if ((utf[n] & 0xf8) == 0xf0 && n + 3 < len) {  // 4 byte utf-8 sequence
+      uint32_t codepoint{static_cast<uint32_t>(
+          (utf[n] & 0x07) << 18 | (utf[n + 1] & 0x3f) << 12 | (utf[n + 2] & 0x3f) << 6 | (utf[n + 3] & 0x3f))};
+      run.emplace_back(codepoint <= 0x10ffff ? codepoint : 0xfffd);
+      n += 4;
+    } else if ((utf[n] & 0xfc) == 0xf8 && n + 4 < len) {  // 5 byte utf-8 sequence
+      run.emplace_back(0xfffd);
+      n += 5;
+    } else if ((utf[n] & 0xfe) == 0xfc && n + 5 < len) {  // 6 byte utf-8 sequence
+      run.emplace_back(0xfffd);
+      n += 6;
+    } else {  // invalid utf-8 sequence
+      run.emplace_back(utf[n]);
+      n += 1;
     }
-    g_signals::parser::string_write(data.substr(0, n).c_str(), n);
-    return n;
-  } else if ((utf[0] & 0xe0) == 0xc0) {  // 2 byte utf-8 sequence
-    g_signals::parser::unicode_text_write((utf[0] & 0x1f) << 6 | (utf[1] & 0x3f));
-    return 2;
-  } else if ((utf[0] & 0xf0) == 0xe0) {  // 3 byte utf-8 sequence
-    g_signals::parser::unicode_text_write((utf[0] & 0xf) << 12 | (utf[1] & 0x3f) << 6 | (utf[2] & 0x3f));
-    return 3;
-  } else if ((utf[0] & 0xf8) == 0xf0) {  // 4 byte utf-8 sequence
-    g_signals::parser::unicode_text_write(0xfffd);
-    return 4;
-  } else if ((utf[0] & 0xfc) == 0xf8) {  // 5 byte utf-8 sequence
-    g_signals::parser::unicode_text_write(0xfffd);
-    return 5;
-  } else if ((utf[0] & 0xfe) == 0xfc) {  // 6 byte utf-8 sequence
-    g_signals::parser::unicode_text_write(0xfffd);
-    return 6;
-  } else {  // invalid utf-8 sequence
-    g_signals::parser::ascii_text_write(utf[0]);
-    return 1;
   }
+
+  op.length = run.size() - op.offset;
+
+  return n;
+}
+
+/**
+ * Append draw operation to the output list
+ */
+void parser::emit(drawop_type type, int32_t value) {
+  drawop op{};
+  op.type = type;
+  op.value = value;
+  m_output->ops.emplace_back(op);
 }
 
 /**
  * Process color hex string and convert it to the correct value
+ *
+ * Accepts #rgb, #rrggbb and #aarrggbb, with or without the hash
  */
-uint32_t parser::parse_color(string s, uint32_t fallback) {
+uint32_t parser::parse_color(string_view s, uint32_t fallback) {
+  if (s.empty() || s[0] == '-') {
+    return fallback;
+  } else if (s[0] == '#') {
+    s.remove_prefix(1);
+  }
+
   uint32_t color{0};
-  if (s.empty() || s[0] == '-' || (color = color_util::parse(s, fallback)) == fallback) {
+
+  for (const char& c : s) {
+    uint32_t nibble;
+
+    if (c >= '0' && c <= '9') {
+      nibble = c - '0';
+    } else if (c >= 'a' && c <= 'f') {
+      nibble = c - 'a' + 10;
+    } else if (c >= 'A' && c <= 'F') {
+      nibble = c - 'A' + 10;
+    } else {
+      return fallback;
+    }
+
+    // Expand #rgb to #rrggbb
+    if (s.size() == 3) {
+      color = color << 8 | nibble << 4 | nibble;
+    } else {
+      color = color << 4 | nibble;
+    }
+  }
+
+  if (s.size() == 3 || s.size() == 6) {
+    color |= 0xFF000000;
+  } else if (s.size() != 8) {
     return fallback;
   }
+
+  if (color == fallback) {
+    return fallback;
+  }
+
   return color_util::premultiply_alpha(color);
 }
 
 /**
  * Process font index and convert it to the correct value
  */
-int8_t parser::parse_fontindex(string s) {
-  if (s.empty() || s[0] == '-') {
+int8_t parser::parse_fontindex(string_view s) {
+  if (s.empty() || !isdigit(s[0])) {
     return -1;
   }
+  return parse_integer(s);
+}
 
-  try {
-    return std::stoul(s, nullptr, 10);
-  } catch (const std::invalid_argument& err) {
-    return -1;
+/**
+ * Process the leading, optionally signed, integer of the given string
+ */
+int32_t parser::parse_integer(string_view s) {
+  int32_t sign{1};
+  int32_t value{0};
+
+  if (!s.empty() && (s[0] == '-' || s[0] == '+')) {
+    sign = s[0] == '-' ? -1 : 1;
+    s.remove_prefix(1);
+  }
+
+  for (const char& c : s) {
+    if (!isdigit(c)) {
+      break;
+    }
+    value = value * 10 + (c - '0');
   }
+
+  return sign * value;
 }
 
 /**
@@ -250,10 +308,10 @@ attribute parser::parse_attr(const char attr) {
 /**
  * Process action button token and convert it to the correct value
  */
-mousebtn parser::parse_action_btn(string data) {
-  if (data[0] == ':') {
+mousebtn parser::parse_action_btn(string_view data) {
+  if (!data.empty() && data[0] == ':') {
     return mousebtn::LEFT;
-  } else if (isdigit(data[0])) {
+  } else if (!data.empty() && isdigit(data[0])) {
     return static_cast<mousebtn>(data[0] - '0');
   } else if (!m_actions.empty()) {
     return static_cast<mousebtn>(m_actions.back());
@@ -263,24 +321,49 @@ mousebtn parser::parse_action_btn(string data) {
 }
 
 /**
- * Process action command string
+ * Process graph samples, a colon followed by comma separated percentages,
+ * and attach them to the last draw operation
  */
-string parser::parse_action_cmd(const string& data) {
-  size_t start{0};
-  while ((start = data.find(':', start)) != string::npos && data[start - 1] == '\\') {
-    start++;
-  }
-  if (start == string::npos) {
-    return "";
-  }
-  size_t end{start + 1};
-  while ((end = data.find(':', end)) != string::npos && data[end - 1] == '\\') {
-    end++;
+void parser::parse_samples(string_view data) {
+  auto& op = m_output->ops.back();
+  op.offset = m_output->samples.size();
+
+  if (!data.empty() && data[0] == ':') {
+    data.remove_prefix(1);
+
+    while (!data.empty()) {
+      m_output->samples.emplace_back(std::max(0, std::min(parse_integer(data), 100)));
+
+      size_t pos{data.find(',')};
+      data.remove_prefix(pos != string_view::npos ? pos + 1 : data.size());
+    }
   }
-  if (end == string::npos) {
-    return "";
+
+  op.length = m_output->samples.size() - op.offset;
+}
+
+/**
+ * Process action command string
+ *
+ * Finds the command wrapped in unescaped colons and
+ * returns the length of the token up to the closing colon
+ */
+size_t parser::parse_action_cmd(string_view data, string_view& cmd) {
+  size_t start{string_view::npos};
+
+  for (size_t i = 0; i < data.size(); i++) {
+    if (data[i] != ':' || (i > 0 && data[i - 1] == '\\')) {
+      continue;
+    } else if (start == string_view::npos) {
+      start = i;
+    } else {
+      cmd = data.substr(start + 1, i - start - 1);
+      return i + 1;
+    }
   }
-  return string_util::trim(data.substr(start, end), ':');
+
+  cmd.clear();
+  return data.size();
 }
 
 POLYBAR_NS_END
@@ -0,0 +1,339 @@
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <algorithm>
+
+#include "components/reactor.hpp"
+#include "errors.hpp"
+#include "utils/scope.hpp"
+
+POLYBAR_NS
+
+/**
+ * Construct reactor instance
+ */
+reactor::reactor(const logger& logger, duration_t slack)
+    : m_log(logger)
+    , m_epoch(clock_t::now())
+    , m_slack(chrono::duration_cast<clock_t::duration>(slack))
+    , m_wheel(0U) {
+  if ((m_epollfd = epoll_create1(EPOLL_CLOEXEC)) == -1) {
+    throw system_error("Failed to create epoll instance");
+  }
+  if ((m_wakeupfd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)) == -1) {
+    close(m_epollfd);
+    throw system_error("Failed to create wakeup eventfd");
+  }
+
+  struct epoll_event event {};
+  event.events = EPOLLIN;
+  event.data.fd = m_wakeupfd;
+  epoll_ctl(m_epollfd, EPOLL_CTL_ADD, m_wakeupfd, &event);
+}
+
+/**
+ * Deconstruct reactor
+ */
+reactor::~reactor() {
+  stop();
+  close(m_wakeupfd);
+  close(m_epollfd);
+}
+
+/**
+ * Start dispatch thread
+ */
+void reactor::start() {
+  if (m_running.exchange(true)) {
+    return;
+  }
+  m_log.trace("reactor: Starting dispatch thread");
+  m_thread = thread(&reactor::dispatch, this);
+}
+
+/**
+ * Stop dispatch thread and wait for it to finish
+ */
+void reactor::stop() {
+  if (!m_running.exchange(false)) {
+    return;
+  }
+  wakeup();
+  if (m_thread.joinable()) {
+    m_thread.join();
+  }
+}
+
+/**
+ * Call handler whenever given fd becomes readable or is hung up
+ */
+void reactor::add_fd(const void* owner, int fd, callback<>&& cb) {
+  std::lock_guard<std::mutex> guard(m_lock);
+
+  struct epoll_event event {};
+  event.events = EPOLLIN;
+  event.data.fd = fd;
+
+  if (epoll_ctl(m_epollfd, EPOLL_CTL_ADD, fd, &event) == -1) {
+    throw system_error("Failed to add fd to epoll instance");
+  }
+
+  m_handlers[fd] = fd_handler{owner, forward<decltype(cb)>(cb)};
+}
+
+/**
+ * Call handler every interval, starting immediately
+ *
+ * Returns the id used to remove this timer alone
+ */
+size_t reactor::add_timer(const void* owner, duration_t interval, callback<>&& cb) {
+  std::lock_guard<std::mutex> guard(m_lock);
+
+  timer_handler timer{};
+  timer.owner = owner;
+  timer.interval = chrono::duration_cast<clock_t::duration>(interval);
+  timer.deadline = clock_t::now();
+  timer.cb = forward<decltype(cb)>(cb);
+
+  m_wheel.add(m_timerid, to_tick(timer.deadline));
+  m_timers.emplace(m_timerid, move(timer));
+
+  wakeup();
+
+  return m_timerid++;
+}
+
+/**
+ * Remove a single timer
+ *
+ * Like remove(), waits for its owner's running handler
+ * to return when called from another thread
+ */
+void reactor::remove_timer(size_t id) {
+  std::unique_lock<std::mutex> guard(m_lock);
+
+  auto timer = m_timers.find(id);
+
+  if (timer == m_timers.end()) {
+    return;
+  }
+
+  const void* owner{timer->second.owner};
+
+  m_wheel.remove(id);
+  m_timers.erase(timer);
+
+  if (std::this_thread::get_id() != m_thread.get_id()) {
+    m_idle.wait(guard, [&] { return m_inflight != owner; });
+  }
+}
+
+/**
+ * Remove all handlers registered by owner
+ *
+ * Waits for a running handler of the owner to return when called
+ * from another thread, so no handler fires after this returns
+ */
+void reactor::remove(const void* owner) {
+  std::unique_lock<std::mutex> guard(m_lock);
+
+  for (auto it = m_handlers.begin(); it != m_handlers.end();) {
+    if (it->second.owner == owner) {
+      epoll_ctl(m_epollfd, EPOLL_CTL_DEL, it->first, nullptr);
+      it = m_handlers.erase(it);
+    } else {
+      it++;
+    }
+  }
+
+  for (auto it = m_timers.begin(); it != m_timers.end();) {
+    if (it->second.owner == owner) {
+      m_wheel.remove(it->first);
+      it = m_timers.erase(it);
+    } else {
+      it++;
+    }
+  }
+
+  // Handlers removing their own owner must not wait for themselves
+  if (std::this_thread::get_id() != m_thread.get_id()) {
+    m_idle.wait(guard, [&] { return m_inflight != owner; });
+  }
+}
+
+/**
+ * Expire all timers registered by owner right away
+ */
+void reactor::trigger(const void* owner) {
+  std::lock_guard<std::mutex> guard(m_lock);
+
+  for (auto&& timer : m_timers) {
+    if (timer.second.owner == owner) {
+      timer.second.deadline = clock_t::now();
+      m_wheel.remove(timer.first);
+      m_wheel.add(timer.first, to_tick(timer.second.deadline));
+    }
+  }
+
+  wakeup();
+}
+
+/**
+ * Set callback fired before (true) and after (false)
+ * each round of handlers, used to batch their updates
+ */
+void reactor::set_batch_cb(callback<bool>&& cb) {
+  std::lock_guard<std::mutex> guard(m_lock);
+  m_batch_cb = forward<decltype(cb)>(cb);
+}
+
+/**
+ * Dispatch thread
+ */
+void reactor::dispatch() {
+  struct epoll_event events[16];
+  vector<pending_call> calls;
+
+  while (m_running) {
+    int timeout;
+    {
+      std::lock_guard<std::mutex> guard(m_lock);
+      timeout = next_timeout();
+    }
+
+    int count = epoll_wait(m_epollfd, events, 16, timeout);
+
+    if (count == -1 && errno != EINTR) {
+      m_log.err("reactor: Failed to wait for events (%s)", strerror(errno));
+      break;
+    }
+
+    callback<bool> batch_cb;
+    {
+      std::lock_guard<std::mutex> guard(m_lock);
+      batch_cb = m_batch_cb;
+
+      for (int i = 0; i < count; i++) {
+        if (events[i].data.fd == m_wakeupfd) {
+          eventfd_t value;
+          eventfd_read(m_wakeupfd, &value);
+          continue;
+        }
+
+        auto handler = m_handlers.find(events[i].data.fd);
+
+        if (handler != m_handlers.end()) {
+          calls.emplace_back(pending_call{handler->second.owner, handler->first, 0U, handler->second.cb});
+        }
+      }
+
+      collect_timers(calls);
+    }
+
+    if (batch_cb) {
+      batch_cb(true);
+    }
+
+    for (auto&& call : calls) {
+      invoke(call);
+    }
+
+    calls.clear();
+
+    if (batch_cb) {
+      batch_cb(false);
+    }
+  }
+
+  m_log.info("reactor: Dispatch thread done");
+}
+
+/**
+ * Collect handlers of all timers expiring within the slack window
+ */
+void reactor::collect_timers(vector<pending_call>& calls) {
+  auto now = clock_t::now();
+  vector<size_t> expired;
+
+  m_wheel.advance(to_tick(now + m_slack), expired);
+
+  if (expired.size() > 1) {
+    m_log.trace_x("reactor: Firing %lu timers in one batch", expired.size());
+  }
+
+  for (auto&& id : expired) {
+    auto timer = m_timers.find(id);
+
+    if (timer == m_timers.end()) {
+      continue;
+    }
+
+    // Skip ticks missed while the system was busy
+    timer->second.deadline = std::max(timer->second.deadline + timer->second.interval, now);
+    m_wheel.add(id, to_tick(timer->second.deadline));
+
+    calls.emplace_back(pending_call{timer->second.owner, -1, id, timer->second.cb});
+  }
+}
+
+/**
+ * Call handler unless it was removed since it was collected
+ */
+void reactor::invoke(const pending_call& call) {
+  {
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    if (!m_running) {
+      return;
+    } else if (call.fd != -1) {
+      auto handler = m_handlers.find(call.fd);
+      if (handler == m_handlers.end() || handler->second.owner != call.owner) {
+        return;
+      }
+    } else if (m_timers.find(call.timer) == m_timers.end()) {
+      return;
+    }
+
+    m_inflight = call.owner;
+  }
+
+  auto done = scope_util::make_exit_handler([this] {
+    {
+      std::lock_guard<std::mutex> guard(m_lock);
+      m_inflight = nullptr;
+    }
+    m_idle.notify_all();
+  });
+
+  call.cb();
+}
+
+/**
+ * Get the number of milliseconds until the next timer expires
+ */
+int reactor::next_timeout() const {
+  uint64_t deadline;
+
+  if (!m_wheel.next_deadline(deadline)) {
+    return -1;
+  }
+
+  uint64_t now{to_tick(clock_t::now())};
+  return deadline > now ? static_cast<int>(std::min<uint64_t>(deadline - now, INT32_MAX)) : 0;
+}
+
+/**
+ * Convert time point to wheel tick (milliseconds since construction)
+ */
+uint64_t reactor::to_tick(clock_t::time_point tp) const {
+  return chrono::duration_cast<chrono::milliseconds>(tp - m_epoch).count();
+}
+
+/**
+ * Interrupt a pending epoll_wait call
+ */
+void reactor::wakeup() {
+  eventfd_write(m_wakeupfd, 1);
+}
+
+POLYBAR_NS_END
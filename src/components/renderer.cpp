@@ -138,6 +138,8 @@ renderer::renderer(connection& conn, const logger& logger, unique_ptr<font_manag
  * Deconstruct instance
  */
 renderer::~renderer() {
+  m_log.trace("renderer: Text layout cache hits: %lu, misses: %lu", m_layouts.hits(), m_layouts.misses());
+
   if (m_window != XCB_NONE) {
     m_connection.destroy_window(m_window);
   }
@@ -161,8 +163,9 @@ void renderer::begin() {
   m_currentx = 0;
   m_attributes = 0;
   m_actions.clear();
+  m_canvas = m_pixmap;
 
-  m_fontmanager->create_xftdraw(m_pixmap, m_colormap);
+  m_fontmanager->create_xftdraw(m_canvas, m_colormap);
 }
 
 /**
@@ -182,50 +185,63 @@ void renderer::end() {
 
 /**
  * Redraw window contents
+ *
+ * Only the area of the pixmap damaged since the last flush is
+ * copied to the window, and the borders are only drawn when the
+ * window contents have been invalidated
  */
 void renderer::flush(bool clear) {
   const xcb_rectangle_t& r = m_rect;
 
-  xcb_rectangle_t top{0, 0, 0U, 0U};
-  top.x += m_bar.borders.at(edge::LEFT).size;
-  top.width += m_bar.size.w - m_bar.borders.at(edge::LEFT).size - m_bar.borders.at(edge::RIGHT).size;
-  top.height += m_bar.borders.at(edge::TOP).size;
+  if (r.x != m_flushed.x || r.y != m_flushed.y || r.width != m_flushed.width || r.height != m_flushed.height) {
+    damage(0, r.width);
+    m_flushed = r;
+  }
 
-  xcb_rectangle_t bottom{0, 0, 0U, 0U};
-  bottom.x += m_bar.borders.at(edge::LEFT).size;
-  bottom.y += m_bar.size.h - m_bar.borders.at(edge::BOTTOM).size;
-  bottom.width += m_bar.size.w - m_bar.borders.at(edge::LEFT).size - m_bar.borders.at(edge::RIGHT).size;
-  bottom.height += m_bar.borders.at(edge::BOTTOM).size;
+  for (auto&& span : m_damage) {
+    m_log.trace("renderer: copy pixmap (x=%i, width=%i, clear=%i)", span.x, span.width, clear);
+    m_connection.copy_area(
+        m_pixmap, m_window, m_gcontexts.at(gc::FG), span.x, 0, r.x + span.x, r.y, span.width, r.height);
+  }
 
-  xcb_rectangle_t left{0, 0, 0U, 0U};
-  left.width += m_bar.borders.at(edge::LEFT).size;
-  left.height += m_bar.size.h;
+  if (m_borders_dirty) {
+    draw_borders();
+  }
 
-  xcb_rectangle_t right{0, 0, 0U, 0U};
-  right.x += m_bar.size.w - m_bar.borders.at(edge::RIGHT).size;
-  right.width += m_bar.borders.at(edge::RIGHT).size;
-  right.height += m_bar.size.h;
+  if (clear) {
+    m_connection.clear_area(false, m_pixmap, 0, 0, r.width, r.height);
+  }
 
-  m_log.trace("renderer: copy pixmap (clear=%i)", clear);
-  m_connection.copy_area(m_pixmap, m_window, m_gcontexts.at(gc::FG), 0, 0, r.x, r.y, r.width, r.height);
+  for (auto&& span : m_damage) {
+    add_span(m_drawn, span.x, span.width);
+  }
 
-  m_log.trace_x("renderer: draw top border (%lupx, %08x)", top.height, m_bar.borders.at(edge::TOP).color);
-  draw_util::fill(m_connection, m_window, m_gcontexts.at(gc::BT), top);
+  m_damage.clear();
+  m_connection.flush();
+}
 
-  m_log.trace_x("renderer: draw bottom border (%lupx, %08x)", bottom.height, m_bar.borders.at(edge::BOTTOM).color);
-  draw_util::fill(m_connection, m_window, m_gcontexts.at(gc::BB), bottom);
+/**
+ * Mark the whole window as needing a redraw, e.g. when exposed
+ */
+void renderer::invalidate() {
+  damage(0, m_rect.width);
+  m_borders_dirty = true;
+}
 
-  m_log.trace_x("renderer: draw left border (%lupx, %08x)", left.width, m_bar.borders.at(edge::LEFT).color);
-  draw_util::fill(m_connection, m_window, m_gcontexts.at(gc::BL), left);
+/**
+ * Mark given area of the window as needing a redraw
+ *
+ * The borders are only redrawn if the area reaches outside
+ * of the content area
+ */
+void renderer::invalidate(int16_t x, int16_t y, uint16_t w, uint16_t h) {
+  const xcb_rectangle_t& r = m_rect;
 
-  m_log.trace_x("renderer: draw right border (%lupx, %08x)", right.width, m_bar.borders.at(edge::RIGHT).color);
-  draw_util::fill(m_connection, m_window, m_gcontexts.at(gc::BR), right);
+  damage(x - r.x, w);
 
-  if (clear) {
-    m_connection.clear_area(false, m_pixmap, 0, 0, r.width, r.height);
+  if (x < r.x || y < r.y || x + w > r.x + r.width || y + h > r.y + r.height) {
+    m_borders_dirty = true;
   }
-
-  m_connection.flush();
 }
 
 /**
@@ -260,6 +276,253 @@ void renderer::reserve_space(edge side, uint16_t w) {
   }
 }
 
+/**
+ * Resize the list of cached segments for given alignment block
+ */
+void renderer::resize_segments(const alignment align, const size_t count) {
+  auto& segments = m_segments[align];
+
+  for (size_t i = count; i < segments.size(); i++) {
+    if (segments[i].pixmap != XCB_NONE) {
+      m_connection.free_pixmap(segments[i].pixmap);
+    }
+  }
+
+  segments.resize(count);
+}
+
+/**
+ * Begin rendering of a single module segment
+ *
+ * The segment is drawn left-aligned onto a scratch pixmap using
+ * the default bar colors and is later copied into its own pixmap
+ */
+void renderer::begin_segment(const alignment align, const size_t index) {
+  m_log.trace_x("renderer: begin_segment(%i, %lu)", static_cast<uint8_t>(align), index);
+
+  if (m_scratch == XCB_NONE) {
+    auto rect = m_bar.inner_area();
+    m_scratch = m_connection.generate_id();
+    m_connection.create_pixmap(32, m_scratch, m_window, rect.width, rect.height);
+  }
+
+  if (m_canvas != m_scratch) {
+    m_fontmanager->destroy_xftdraw();
+    m_fontmanager->create_xftdraw(m_scratch, m_colormap);
+    m_canvas = m_scratch;
+  }
+
+  m_segment = &m_segments[align].at(index);
+  m_alignment = alignment::LEFT;
+  m_currentx = 0;
+  m_attributes = 0;
+  m_actions.clear();
+
+  set_background(m_bar.background);
+  set_foreground(m_bar.foreground);
+  set_underline(m_bar.underline.color);
+  set_overline(m_bar.overline.color);
+  set_fontindex(DEFAULT_FONT_INDEX);
+
+  draw_util::fill(m_connection, m_canvas, m_gcontexts.at(gc::BG), 0, 0, m_rect.width, m_rect.height);
+}
+
+/**
+ * End rendering of the current module segment
+ */
+void renderer::end_segment() {
+  if (m_segment == nullptr) {
+    return;
+  }
+
+  auto& seg = *m_segment;
+  uint16_t width{std::min(m_currentx, m_rect.width)};
+
+  m_log.trace_x("renderer: end_segment(%i)", width);
+
+  if (seg.pixmap != XCB_NONE && seg.width != width) {
+    m_connection.free_pixmap(seg.pixmap);
+    seg.pixmap = XCB_NONE;
+  }
+
+  if (seg.pixmap == XCB_NONE && width) {
+    seg.pixmap = m_connection.generate_id();
+    m_connection.create_pixmap(32, seg.pixmap, m_window, width, m_rect.height);
+  }
+
+  if (width) {
+    m_connection.copy_area(m_scratch, seg.pixmap, m_gcontexts.at(gc::FG), 0, 0, 0, 0, width, m_rect.height);
+  }
+
+  seg.width = width;
+  seg.dirty = true;
+  seg.actions.swap(m_actions);
+
+  m_actions.clear();
+  m_segment = nullptr;
+}
+
+/**
+ * Position the cached segments and copy them onto the window pixmap
+ *
+ * Only segments that were re-rendered or that had to move
+ * because a neighbour changed width are copied
+ */
+void renderer::compose_segments() {
+  bool redraw{!m_composed};
+  map<alignment, xcb_rectangle_t> extents;
+
+  // Restore the bar background used to clear vacated areas
+  if (m_colors[gc::BG] != m_bar.background) {
+    m_connection.change_gc(m_gcontexts.at(gc::BG), XCB_GC_FOREGROUND, &m_bar.background);
+    m_colors[gc::BG] = m_bar.background;
+  }
+
+  for (auto&& block : m_segments) {
+    xcb_rectangle_t ext{0, 0, 0U, m_rect.height};
+
+    for (auto&& seg : block.second) {
+      ext.width += seg.width;
+    }
+
+    if (block.first == alignment::CENTER) {
+      ext.x = m_rect.width / 2 - ext.width / 2;
+    } else if (block.first == alignment::RIGHT) {
+      ext.x = m_rect.width - ext.width;
+    }
+
+    extents.emplace(block.first, ext);
+  }
+
+  // Overlapping blocks cannot be composed independently
+  auto overlapping = [](const map<alignment, xcb_rectangle_t>& blocks) {
+    int16_t edge_x{0};
+    for (auto&& ext : blocks) {
+      if (!ext.second.width) {
+        continue;
+      } else if (ext.second.x < edge_x) {
+        return true;
+      }
+      edge_x = ext.second.x + ext.second.width;
+    }
+    return false;
+  };
+
+  if (overlapping(extents) || overlapping(m_extents)) {
+    redraw = true;
+  }
+
+  if (redraw) {
+    m_log.trace_x("renderer: compose_segments (redraw)");
+    fill_background();
+  } else {
+    // Clear the areas that are no longer covered by the blocks
+    for (auto&& ext : extents) {
+      const auto& old = m_extents[ext.first];
+      const auto& cur = ext.second;
+
+      if (!old.width) {
+        continue;
+      } else if (old.x < cur.x) {
+        int16_t end_x = std::min<int16_t>(old.x + old.width, cur.x);
+        draw_util::fill(m_connection, m_pixmap, m_gcontexts.at(gc::BG), old.x, 0, end_x - old.x, m_rect.height);
+        damage(old.x, end_x - old.x);
+      }
+
+      if (old.x + old.width > cur.x + cur.width) {
+        int16_t start_x = std::max<int16_t>(old.x, cur.x + cur.width);
+        draw_util::fill(m_connection, m_pixmap, m_gcontexts.at(gc::BG), start_x, 0, old.x + old.width - start_x,
+            m_rect.height);
+        damage(start_x, old.x + old.width - start_x);
+      }
+    }
+  }
+
+  m_actions.clear();
+
+  for (auto&& block : m_segments) {
+    int16_t x{extents[block.first].x};
+
+    for (auto&& seg : block.second) {
+      if (seg.width && (redraw || seg.dirty || seg.x != x)) {
+        m_log.trace_x("renderer: copy segment (x=%i, width=%i)", x, seg.width);
+        m_connection.copy_area(seg.pixmap, m_pixmap, m_gcontexts.at(gc::FG), 0, 0, x, 0, seg.width, m_rect.height);
+        damage(x, seg.width);
+      }
+
+      for (auto action : seg.actions) {
+        action.align = block.first;
+        action.start_x += x;
+        action.end_x += x;
+        m_actions.emplace_back(move(action));
+      }
+
+      seg.x = x;
+      seg.dirty = false;
+      x += seg.width;
+    }
+  }
+
+  m_extents.swap(extents);
+  m_composed = true;
+}
+
+/**
+ * Replay the operations of a compiled draw list
+ */
+void renderer::render(const drawlist& list) {
+  m_log.trace_x("renderer: render(%lu)", list.ops.size());
+
+  for (auto&& op : list.ops) {
+    switch (op.type) {
+      case drawop_type::NONE:
+        break;
+      case drawop_type::BACKGROUND:
+        set_background(static_cast<uint32_t>(op.value));
+        break;
+      case drawop_type::FOREGROUND:
+        set_foreground(static_cast<uint32_t>(op.value));
+        break;
+      case drawop_type::UNDERLINE:
+        set_underline(static_cast<uint32_t>(op.value));
+        break;
+      case drawop_type::OVERLINE:
+        set_overline(static_cast<uint32_t>(op.value));
+        break;
+      case drawop_type::FONT:
+        set_fontindex(static_cast<int8_t>(op.value));
+        break;
+      case drawop_type::OFFSET:
+        fill_shift(static_cast<int16_t>(op.value));
+        break;
+      case drawop_type::ALIGNMENT:
+        set_alignment(static_cast<alignment>(op.value));
+        break;
+      case drawop_type::ATTRIBUTE_SET:
+        set_attribute(static_cast<attribute>(op.value), true);
+        break;
+      case drawop_type::ATTRIBUTE_UNSET:
+        set_attribute(static_cast<attribute>(op.value), false);
+        break;
+      case drawop_type::ATTRIBUTE_TOGGLE:
+        toggle_attribute(static_cast<attribute>(op.value));
+        break;
+      case drawop_type::ACTION_OPEN:
+        begin_action(static_cast<mousebtn>(op.value), list.commands.substr(op.offset, op.length));
+        break;
+      case drawop_type::ACTION_CLOSE:
+        end_action(static_cast<mousebtn>(op.value));
+        break;
+      case drawop_type::TEXT:
+        draw_textstring(&list.text[op.offset], op.length);
+        break;
+      case drawop_type::GRAPH:
+        draw_graph(&list.samples[op.offset], op.length, static_cast<uint16_t>(op.value));
+        break;
+    }
+  }
+}
+
 /**
  * Change value of background gc
  */
@@ -326,7 +589,9 @@ void renderer::set_fontindex(const int8_t font) {
  * Change current alignment
  */
 void renderer::set_alignment(const alignment align) {
-  if (align == m_alignment) {
+  if (m_segment != nullptr) {
+    return m_log.trace_x("renderer: ignoring alignment change inside segment");
+  } else if (align == m_alignment) {
     return m_log.trace_x("renderer: ignoring unchanged alignment(%i)", static_cast<uint8_t>(align));
   }
 
@@ -363,12 +628,113 @@ bool renderer::check_attribute(const attribute attr) {
   return (m_attributes >> static_cast<uint8_t>(attr)) & 1U;
 }
 
+/**
+ * Draw the bar borders onto the window
+ */
+void renderer::draw_borders() {
+  xcb_rectangle_t top{0, 0, 0U, 0U};
+  top.x += m_bar.borders.at(edge::LEFT).size;
+  top.width += m_bar.size.w - m_bar.borders.at(edge::LEFT).size - m_bar.borders.at(edge::RIGHT).size;
+  top.height += m_bar.borders.at(edge::TOP).size;
+
+  xcb_rectangle_t bottom{0, 0, 0U, 0U};
+  bottom.x += m_bar.borders.at(edge::LEFT).size;
+  bottom.y += m_bar.size.h - m_bar.borders.at(edge::BOTTOM).size;
+  bottom.width += m_bar.size.w - m_bar.borders.at(edge::LEFT).size - m_bar.borders.at(edge::RIGHT).size;
+  bottom.height += m_bar.borders.at(edge::BOTTOM).size;
+
+  xcb_rectangle_t left{0, 0, 0U, 0U};
+  left.width += m_bar.borders.at(edge::LEFT).size;
+  left.height += m_bar.size.h;
+
+  xcb_rectangle_t right{0, 0, 0U, 0U};
+  right.x += m_bar.size.w - m_bar.borders.at(edge::RIGHT).size;
+  right.width += m_bar.borders.at(edge::RIGHT).size;
+  right.height += m_bar.size.h;
+
+  m_log.trace_x("renderer: draw top border (%lupx, %08x)", top.height, m_bar.borders.at(edge::TOP).color);
+  draw_util::fill(m_connection, m_window, m_gcontexts.at(gc::BT), top);
+
+  m_log.trace_x("renderer: draw bottom border (%lupx, %08x)", bottom.height, m_bar.borders.at(edge::BOTTOM).color);
+  draw_util::fill(m_connection, m_window, m_gcontexts.at(gc::BB), bottom);
+
+  m_log.trace_x("renderer: draw left border (%lupx, %08x)", left.width, m_bar.borders.at(edge::LEFT).color);
+  draw_util::fill(m_connection, m_window, m_gcontexts.at(gc::BL), left);
+
+  m_log.trace_x("renderer: draw right border (%lupx, %08x)", right.width, m_bar.borders.at(edge::RIGHT).color);
+  draw_util::fill(m_connection, m_window, m_gcontexts.at(gc::BR), right);
+
+  m_borders_dirty = false;
+}
+
+/**
+ * Add horizontal span of the window pixmap to the area
+ * that needs to be copied to the window on the next flush
+ */
+void renderer::damage(int16_t x, uint16_t w) {
+  add_span(m_damage, x, w);
+}
+
+/**
+ * Add horizontal span to a sorted list of disjoint spans
+ *
+ * Overlapping and adjacent spans are merged. Once there are more
+ * than MAX_DAMAGE spans, the two closest ones are merged as well
+ */
+void renderer::add_span(vector<xcb_rectangle_t>& spans, int16_t x, uint16_t w) const {
+  int32_t start_x{std::max<int32_t>(x, 0)};
+  int32_t end_x{std::min<int32_t>(x + w, m_rect.width)};
+
+  if (end_x <= start_x) {
+    return;
+  }
+
+  // Spans are kept sorted by position
+  auto it = spans.begin();
+  while (it != spans.end() && it->x + it->width < start_x) {
+    it++;
+  }
+  while (it != spans.end() && it->x <= end_x) {
+    start_x = std::min<int32_t>(start_x, it->x);
+    end_x = std::max<int32_t>(end_x, it->x + it->width);
+    it = spans.erase(it);
+  }
+
+  spans.insert(it, xcb_rectangle_t{static_cast<int16_t>(start_x), 0, static_cast<uint16_t>(end_x - start_x),
+                       m_rect.height});
+
+  if (spans.size() > MAX_DAMAGE) {
+    size_t closest{0U};
+    for (size_t i = 1; i + 1 < spans.size(); i++) {
+      auto gap = [&](size_t n) { return spans[n + 1].x - (spans[n].x + spans[n].width); };
+      if (gap(i) < gap(closest)) {
+        closest = i;
+      }
+    }
+
+    auto& span = spans[closest];
+    span.width = spans[closest + 1].x + spans[closest + 1].width - span.x;
+    spans.erase(spans.begin() + closest + 1);
+  }
+}
+
 /**
  * Fill background area
+ *
+ * Only the spans drawn on since the previous fill can differ
+ * from the window contents, anything drawn from now on
+ * damages its own area
  */
 void renderer::fill_background() {
   m_log.trace_x("renderer: fill_background");
   draw_util::fill(m_connection, m_pixmap, m_gcontexts.at(gc::BG), 0, 0, m_rect.width, m_rect.height);
+
+  for (auto&& span : m_drawn) {
+    damage(span.x, span.width);
+  }
+
+  m_drawn.clear();
+  m_composed = false;
 }
 
 /**
@@ -381,7 +747,7 @@ void renderer::fill_overline(int16_t x, uint16_t w) {
     return m_log.trace_x("renderer: not filling overline (size=0)");
   }
   m_log.trace_x("renderer: fill_overline(%i, #%08x)", m_bar.overline.size, m_colors[gc::OL]);
-  draw_util::fill(m_connection, m_pixmap, m_gcontexts.at(gc::OL), x, 0, w, m_bar.overline.size);
+  draw_util::fill(m_connection, m_canvas, m_gcontexts.at(gc::OL), x, 0, w, m_bar.overline.size);
 }
 
 /**
@@ -395,7 +761,7 @@ void renderer::fill_underline(int16_t x, uint16_t w) {
   }
   m_log.trace_x("renderer: fill_underline(%i, #%08x)", m_bar.underline.size, m_colors[gc::UL]);
   int16_t y{static_cast<int16_t>(m_rect.height - m_bar.underline.size)};
-  draw_util::fill(m_connection, m_pixmap, m_gcontexts.at(gc::UL), x, y, w, m_bar.underline.size);
+  draw_util::fill(m_connection, m_canvas, m_gcontexts.at(gc::UL), x, y, w, m_bar.underline.size);
 }
 
 /**
@@ -406,84 +772,122 @@ void renderer::fill_shift(const int16_t px) {
 }
 
 /**
- * Draw character glyph
+ * Draw character glyphs
+ *
+ * Consecutive characters that resolve to the same font
+ * are drawn as a single run
  */
-void renderer::draw_character(uint16_t character) {
-  m_log.trace_x("renderer: draw_character");
+void renderer::draw_textstring(const uint32_t* text, size_t len) {
+  m_log.trace_x("renderer: draw_textstring(%lu)", len);
+
+  for (auto&& run : layout_textstring(text, len).runs) {
+    auto& font = *run.font;
+    auto x = shift_content(run.width);
+    auto y = m_rect.height / 2 + font->height / 2 - font->descent + font->offset_y;
+
+    if (font->xft != nullptr) {
+      auto color = m_fontmanager->xftcolor();
+      const FcChar32* drawchars = reinterpret_cast<const FcChar32*>(&text[run.offset]);
+      XftDrawString32(m_fontmanager->xftdraw(), &color, font->xft, x, y, drawchars, run.length);
+    } else {
+      if (font->ptr != m_gcfont) {
+        m_gcfont = font->ptr;
+        m_fontmanager->set_gcontext_font(m_gcontexts.at(gc::FG), m_gcfont);
+      }
+
+      // Core fonts only cover the BMP and take big-endian 16-bit characters
+      m_glyphs.clear();
+      for (size_t i = run.offset; i < run.offset + run.length; i++) {
+        m_glyphs.emplace_back((text[i] >> 8 & 0xff) | (text[i] << 8 & 0xff00));
+      }
 
-  auto& font = m_fontmanager->match_char(character);
+      // A single text item holds at most 254 characters
+      int16_t offset_x{x};
+      for (size_t i = 0; i < m_glyphs.size(); i += 254) {
+        uint8_t chunk = std::min<size_t>(m_glyphs.size() - i, 254);
+        draw_util::xcb_poly_text_16_patched(
+            m_connection, m_canvas, m_gcontexts.at(gc::FG), offset_x, y, chunk, &m_glyphs[i]);
+        for (size_t j = run.offset + i; j < run.offset + i + chunk; j++) {
+          offset_x += m_fontmanager->char_width(font, text[j]);
+        }
+      }
+    }
 
-  if (!font) {
-    return m_log.warn("No suitable font found (character=%i)", character);
+    fill_underline(x, run.width);
+    fill_overline(x, run.width);
   }
+}
 
-  if (font->ptr && font->ptr != m_gcfont) {
-    m_gcfont = font->ptr;
-    m_fontmanager->set_gcontext_font(m_gcontexts.at(gc::FG), m_gcfont);
+/**
+ * Draw graph bars, one per sample, each scaled
+ * to the given percentage of the bar height
+ */
+void renderer::draw_graph(const uint8_t* samples, size_t len, uint16_t step) {
+  m_log.trace_x("renderer: draw_graph(%lu, %u)", len, step);
+
+  if (len == 0 || step == 0) {
+    return;
   }
 
-  auto width = m_fontmanager->char_width(font, character);
-  auto x = shift_content(width);
-  auto y = m_rect.height / 2 + font->height / 2 - font->descent + font->offset_y;
+  uint16_t width{static_cast<uint16_t>(len * step)};
+  int16_t x{shift_content(width)};
 
-  if (font->xft != nullptr) {
-    auto color = m_fontmanager->xftcolor();
-    XftDrawString16(m_fontmanager->xftdraw(), &color, font->xft, x, y, &character, 1);
-  } else {
-    uint16_t ucs = ((character >> 8) | (character << 8));
-    draw_util::xcb_poly_text_16_patched(m_connection, m_pixmap, m_gcontexts.at(gc::FG), x, y, 1, &ucs);
+  m_graphbars.clear();
+
+  for (size_t i = 0; i < len; i++) {
+    uint16_t height{static_cast<uint16_t>(m_rect.height * samples[i] / 100)};
+    if (height > 0) {
+      int16_t bar_x{static_cast<int16_t>(x + i * step)};
+      int16_t bar_y{static_cast<int16_t>(m_rect.height - height)};
+      m_graphbars.push_back({bar_x, bar_y, step, height});
+    }
   }
 
+  draw_util::fill(m_connection, m_canvas, m_gcontexts.at(gc::FG), m_graphbars);
+
   fill_underline(x, width);
   fill_overline(x, width);
 }
 
 /**
- * Draw character glyphs
+ * Split text into runs of characters drawn with the same font
+ *
+ * Layouts are cached by preferred font and text, so unchanged
+ * labels are only matched and measured the first time they're drawn
  */
-void renderer::draw_textstring(const char* text, size_t len) {
-  m_log.trace_x("renderer: draw_textstring(\"%s\")", text);
-
-  for (size_t n = 0; n < len; n++) {
-    vector<uint16_t> chars;
-    chars.emplace_back(text[n]);
+const renderer::textlayout& renderer::layout_textstring(const uint32_t* text, size_t len) {
+  m_layoutkey.assign(1, static_cast<uint8_t>(m_fontindex));
+  m_layoutkey.append(text, text + len);
 
-    auto& font = m_fontmanager->match_char(chars[0]);
+  auto cached = m_layouts.find(m_layoutkey);
+  if (cached != nullptr) {
+    return *cached;
+  }
 
-    if (!font) {
-      return m_log.warn("No suitable font found (character=%i)", chars[0]);
-    }
+  textlayout layout{};
 
-    if (font->ptr && font->ptr != m_gcfont) {
-      m_gcfont = font->ptr;
-      m_fontmanager->set_gcontext_font(m_gcontexts.at(gc::FG), m_gcfont);
-    }
+  for (size_t n = 0; n < len;) {
+    auto& font = m_fontmanager->match_char(text[n]);
 
-    while (n + 1 < len && text[n + 1] == chars[0]) {
-      chars.emplace_back(text[++n]);
+    if (!font) {
+      m_log.warn("No suitable font found (character=%i)", text[n++]);
+      continue;
     }
 
-    // TODO: cache
-    auto width = m_fontmanager->char_width(font, chars[0]) * chars.size();
-    auto x = shift_content(width);
-    auto y = m_rect.height / 2 + font->height / 2 - font->descent + font->offset_y;
+    textrun run{};
+    run.font = &font;
+    run.offset = n;
 
-    if (font->xft != nullptr) {
-      auto color = m_fontmanager->xftcolor();
-      const FcChar16* drawchars = static_cast<const FcChar16*>(chars.data());
-      XftDrawString16(m_fontmanager->xftdraw(), &color, font->xft, x, y, drawchars, chars.size());
-    } else {
-      for (unsigned short& i : chars) {
-        i = ((i >> 8) | (i << 8));
-      }
-
-      draw_util::xcb_poly_text_16_patched(
-          m_connection, m_pixmap, m_gcontexts.at(gc::FG), x, y, chars.size(), chars.data());
+    while (n < len && (n == run.offset || &m_fontmanager->match_char(text[n]) == &font)) {
+      run.width += m_fontmanager->char_width(font, text[n++]);
     }
 
-    fill_underline(x, width);
-    fill_overline(x, width);
+    run.length = n - run.offset;
+    layout.width += run.width;
+    layout.runs.emplace_back(run);
   }
+
+  return m_layouts.insert(m_layoutkey, move(layout));
 }
 
 /**
@@ -553,6 +957,7 @@ int16_t renderer::shift_content(int16_t x, const int16_t shift_x) {
   m_log.trace_x("renderer: shift_content(%i)", shift_x);
 
   int16_t base_x{0};
+  int16_t damage_x{x};
   double delta{static_cast<double>(shift_x)};
 
   switch (m_alignment) {
@@ -562,20 +967,30 @@ int16_t renderer::shift_content(int16_t x, const int16_t shift_x) {
       break;
     case alignment::CENTER:
       base_x = static_cast<int16_t>(m_rect.width / 2);
-      m_connection.copy_area(m_pixmap, m_pixmap, m_gcontexts.at(gc::FG), base_x - x / 2, 0, base_x - (x + shift_x) / 2,
-          0, x, m_rect.height);
+      damage_x = base_x - (x + shift_x) / 2;
+      m_connection.copy_area(
+          m_canvas, m_canvas, m_gcontexts.at(gc::FG), base_x - x / 2, 0, damage_x, 0, x, m_rect.height);
       x = base_x - (x + shift_x) / 2 + x;
       delta /= 2;
       break;
     case alignment::RIGHT:
       base_x = static_cast<int16_t>(m_rect.width - x);
+      damage_x = base_x - shift_x;
       m_connection.copy_area(
-          m_pixmap, m_pixmap, m_gcontexts.at(gc::FG), base_x, 0, base_x - shift_x, 0, x, m_rect.height);
+          m_canvas, m_canvas, m_gcontexts.at(gc::FG), base_x, 0, base_x - shift_x, 0, x, m_rect.height);
       x = m_rect.width - shift_x;
       break;
   }
 
-  draw_util::fill(m_connection, m_pixmap, m_gcontexts.at(gc::BG), x, 0, m_rect.width - x, m_rect.height);
+  // Only the area opened for the new content needs to be cleared,
+  // and the tail vacated by right aligned content, which ends there
+  uint16_t fill_w{static_cast<uint16_t>(std::max(0, std::min<int>(shift_x, m_rect.width - x)))};
+  draw_util::fill(m_connection, m_canvas, m_gcontexts.at(gc::BG), x, 0, fill_w, m_rect.height);
+
+  if (m_canvas == m_pixmap) {
+    damage_x = std::min(damage_x, x);
+    damage(damage_x, x + fill_w - damage_x);
+  }
 
   // Translate pos of clickable areas
   if (m_alignment != alignment::LEFT) {
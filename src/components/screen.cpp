@@ -37,6 +37,8 @@ screen::screen(connection& conn, const logger& logger, const config& conf)
     return;
   }
 
+  m_monitor = find_monitor(m_monitors);
+
   // clang-format off
   m_proxy = winspec(m_connection)
     << cw_size(1U, 1U)
@@ -78,7 +80,8 @@ screen::~screen() {
 /**
  * Handle XCB_RANDR_SCREEN_CHANGE_NOTIFY events
  *
- * If the screen dimensions have changed we raise USR1 to trigger a reload
+ * If the screen dimensions have changed we raise USR1 to trigger a reload,
+ * unless the monitor used by the bar is left as it was
  */
 void screen::handle(const evt::randr_screen_change_notify& evt) {
   if (m_sigraised || evt->request_window != m_proxy) {
@@ -86,13 +89,12 @@ void screen::handle(const evt::randr_screen_change_notify& evt) {
   }
 
   auto screen = m_connection.screen(true);
+  auto monitors = randr_util::get_monitors(m_connection, m_root, true);
   auto changed = false;
 
   if (screen->width_in_pixels != m_size.w || screen->height_in_pixels != m_size.h) {
     changed = true;
   } else {
-    auto monitors = randr_util::get_monitors(m_connection, m_root, true);
-
     for (size_t n = 0; n < monitors.size(); n++) {
       if (n < m_monitors.size() && monitors[n]->output != m_monitors[n]->output) {
         changed = true;
@@ -104,9 +106,40 @@ void screen::handle(const evt::randr_screen_change_notify& evt) {
     return;
   }
 
+  // Avoid tearing down the bar for changes to other monitors
+  auto monitor = find_monitor(monitors);
+
+  if (m_monitor && monitor && m_monitor->output == monitor->output && m_monitor->x == monitor->x &&
+      m_monitor->y == monitor->y && m_monitor->w == monitor->w && m_monitor->h == monitor->h) {
+    m_log.info("randr_screen_change_notify (%ux%u)... monitor %s unchanged", evt->width, evt->height, monitor->name);
+    m_size = {screen->width_in_pixels, screen->height_in_pixels};
+    m_monitors = move(monitors);
+    return;
+  }
+
   m_log.warn("randr_screen_change_notify (%ux%u)... reloading", evt->width, evt->height);
   m_sigraised = true;
   g_signals::event::enqueue(eventloop::make(quit_event{}, true));
 }
 
+/**
+ * Find the monitor used by the bar, the same way the bar does
+ */
+monitor_t screen::find_monitor(const vector<monitor_t>& monitors) const {
+  auto name = m_conf.get<string>(m_conf.bar_section(), "monitor", "");
+  auto strict = m_conf.get<bool>(m_conf.bar_section(), "monitor-strict", false);
+
+  if (name.empty()) {
+    return monitors.empty() ? nullptr : monitors[0];
+  }
+
+  for (auto&& monitor : monitors) {
+    if (monitor->match(name, strict)) {
+      return monitor;
+    }
+  }
+
+  return nullptr;
+}
+
 POLYBAR_NS_END
@@ -0,0 +1,93 @@
+#include "drawtypes/graph.hpp"
+#include "utils/math.hpp"
+
+POLYBAR_NS
+
+namespace drawtypes {
+  graph::graph(const bar_settings& bar, size_t samples, unsigned int step, float max)
+      : m_builder(make_unique<builder>(bar)), m_samples(samples), m_step(step), m_max(max) {}
+
+  void graph::set_foreground(string color) {
+    m_foreground = move(color);
+  }
+
+  /**
+   * Append sample, dropping the oldest one
+   */
+  void graph::add(float value) {
+    m_samples.push(value);
+  }
+
+  /**
+   * Get the graph tag for the current samples
+   *
+   * Samples are scaled to percentages of the configured max, or of
+   * the largest sample in the history if no max is set. Missing
+   * samples are padded so the graph always has the same width
+   */
+  string graph::output() {
+    float max{m_max};
+
+    if (max <= 0.0f) {
+      for (size_t i = 0; i < m_samples.size(); i++) {
+        max = std::max(max, m_samples[i]);
+      }
+    }
+
+    string samples;
+    samples.reserve(m_samples.capacity() * 4);
+
+    for (size_t i = m_samples.size(); i < m_samples.capacity(); i++) {
+      samples += "0,";
+    }
+
+    for (size_t i = 0; i < m_samples.size(); i++) {
+      float perc{max > 0.0f ? m_samples[i] / max * 100.0f : 0.0f};
+      samples += to_string(static_cast<int>(math_util::cap(perc, 0.0f, 100.0f) + 0.5f)) + ",";
+    }
+
+    if (!samples.empty()) {
+      samples.pop_back();
+    }
+
+    if (!m_foreground.empty()) {
+      m_builder->color(m_foreground);
+    }
+
+    m_builder->graph(m_step, samples);
+
+    if (!m_foreground.empty()) {
+      m_builder->color_close();
+    }
+
+    return m_builder->flush();
+  }
+
+  /**
+   * Create a graph by loading values
+   * from the configuration
+   */
+  graph_t load_graph(const bar_settings& bar, const config& conf, const string& section, string name, float max) {
+    // Remove the start and end tag from the name in case a format tag is passed
+    name = string_util::ltrim(string_util::rtrim(name, '>'), '<');
+
+    unsigned int samples;
+    unsigned int step;
+
+    if ((samples = conf.get<decltype(samples)>(section, name + "-width")) < 1) {
+      throw application_error("Invalid width defined at [" + conf.build_path(section, name) + "]");
+    }
+    if ((step = conf.get<decltype(step)>(section, name + "-step", 2U)) < 1) {
+      throw application_error("Invalid step defined at [" + conf.build_path(section, name) + "]");
+    }
+
+    max = conf.get<float>(section, name + "-max", max);
+
+    graph_t graph{new graph_t::element_type(bar, samples, step, max)};
+    graph->set_foreground(conf.get<string>(section, name + "-foreground", ""));
+
+    return graph;
+  }
+}
+
+POLYBAR_NS_END
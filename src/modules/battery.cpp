@@ -121,7 +121,30 @@ namespace modules {
    */
   void battery_module::start() {
     inotify_module::start();
-    m_threads.emplace_back(thread(&battery_module::subthread, this));
+
+    if (!m_reactor) {
+      m_threads.emplace_back(thread(&battery_module::subthread, this));
+      return;
+    } else if (!running()) {
+      return;
+    }
+
+    // Run the polling fallback and the charging animation on the shared loop
+    if (m_interval.count() > 0) {
+      m_reactor->add_timer(this, m_interval, bind(&battery_module::poll_values, this));
+    }
+
+    chrono::duration<double> dur = 1s;
+
+    if (m_animation_charging) {
+      dur = chrono::duration<double>(float(m_animation_charging->framerate()) / 1000.0f);
+    }
+
+    m_reactor->add_timer(this, dur, [this] {
+      if (m_state == battery_state::CHARGING) {
+        broadcast();
+      }
+    });
   }
 
   /**
@@ -141,16 +164,7 @@ namespace modules {
    * report inotify events for files on sysfs.
    */
   void battery_module::idle() {
-    if (m_interval.count() > 0) {
-      auto now = chrono::system_clock::now();
-
-      if (chrono::duration_cast<decltype(m_interval)>(now - m_lastpoll) > m_interval) {
-        m_lastpoll = now;
-        m_log.info("%s: Polling values (inotify fallback)", name());
-        file_util::get_contents(m_valuepath[battery_value::CAPACITY_PERC]);
-      }
-    }
-
+    poll_values();
     inotify_module::idle();
   }
 
@@ -324,6 +338,22 @@ namespace modules {
     return {buffer};
   }
 
+  /**
+   * Read the capacity file if no inotify event has been
+   * reported within the defined interval
+   */
+  void battery_module::poll_values() {
+    if (m_interval.count() > 0) {
+      auto now = chrono::system_clock::now();
+
+      if (chrono::duration_cast<decltype(m_interval)>(now - m_lastpoll) > m_interval) {
+        m_lastpoll = now;
+        m_log.info("%s: Polling values (inotify fallback)", name());
+        file_util::get_contents(m_valuepath[battery_value::CAPACITY_PERC]);
+      }
+    }
+  }
+
   /**
    * Subthread runner that emit update events
    * to refresh <animation-charging> in case it is used.
@@ -148,6 +148,10 @@ namespace modules {
     return bytes > 0;
   }
 
+  int bspwm_module::get_file_descriptor() const {
+    return m_subscriber ? m_subscriber->get_file_descriptor() : -1;
+  }
+
   bool bspwm_module::update() {
     ssize_t bytes = 0;
     string data = m_subscriber->receive(BUFSIZ - 1, bytes, 0);
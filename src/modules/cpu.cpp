@@ -1,5 +1,6 @@
 #include "modules/cpu.hpp"
 
+#include "drawtypes/graph.hpp"
 #include "drawtypes/label.hpp"
 #include "drawtypes/progressbar.hpp"
 #include "drawtypes/ramp.hpp"
@@ -16,12 +17,17 @@ namespace modules {
 
   void cpu_module::setup() {
     m_interval = chrono::duration<double>(m_conf.get<float>(name(), "interval", 1));
+    m_sampler = proc_util::make_sampler();
 
-    m_formatter->add(DEFAULT_FORMAT, TAG_LABEL, {TAG_LABEL, TAG_BAR_LOAD, TAG_RAMP_LOAD, TAG_RAMP_LOAD_PER_CORE});
+    m_formatter->add(
+        DEFAULT_FORMAT, TAG_LABEL, {TAG_LABEL, TAG_BAR_LOAD, TAG_GRAPH_LOAD, TAG_RAMP_LOAD, TAG_RAMP_LOAD_PER_CORE});
 
     if (m_formatter->has(TAG_BAR_LOAD)) {
       m_barload = load_progressbar(m_bar, m_conf, name(), TAG_BAR_LOAD);
     }
+    if (m_formatter->has(TAG_GRAPH_LOAD)) {
+      m_graphload = load_graph(m_bar, m_conf, name(), TAG_GRAPH_LOAD, 100.0f);
+    }
     if (m_formatter->has(TAG_RAMP_LOAD)) {
       m_rampload = load_ramp(m_conf, name(), TAG_RAMP_LOAD);
     }
@@ -45,7 +51,7 @@ namespace modules {
     m_total = 0.0f;
     m_load.clear();
 
-    auto cores_n = m_cputimes.size();
+    auto cores_n = m_cputimes->cores.size();
 
     if (!cores_n) {
       return false;
@@ -59,6 +65,10 @@ namespace modules {
 
     m_total = m_total / static_cast<float>(cores_n);
 
+    if (m_graphload) {
+      m_graphload->add(m_total);
+    }
+
     if (m_label) {
       m_label->reset_tokens();
       m_label->replace_token("%percentage%", to_string(static_cast<int>(m_total + 0.5f)) + "%");
@@ -72,6 +82,8 @@ namespace modules {
       builder->node(m_label);
     } else if (tag == TAG_BAR_LOAD) {
       builder->node(m_barload->output(m_total));
+    } else if (tag == TAG_GRAPH_LOAD) {
+      builder->node(m_graphload->output());
     } else if (tag == TAG_RAMP_LOAD) {
       builder->node(m_rampload->get_by_percentage(m_total));
     } else if (tag == TAG_RAMP_LOAD_PER_CORE) {
@@ -90,50 +102,38 @@ namespace modules {
   }
 
   bool cpu_module::read_values() {
-    m_cputimes_prev.swap(m_cputimes);
-    m_cputimes.clear();
-
     try {
-      std::ifstream in(PATH_CPU_INFO);
-      string str;
+      auto snapshot = m_sampler->cpu();
 
-      while (std::getline(in, str) && str.compare(0, 3, "cpu") == 0) {
-        // skip line with accumulated value
-        if (str.compare(0, 4, "cpu ") == 0) {
-          continue;
-        }
-
-        auto values = string_util::split(str, ' ');
-
-        m_cputimes.emplace_back(new cpu_time);
-        m_cputimes.back()->user = std::stoull(values[1], nullptr, 10);
-        m_cputimes.back()->nice = std::stoull(values[2], nullptr, 10);
-        m_cputimes.back()->system = std::stoull(values[3], nullptr, 10);
-        m_cputimes.back()->idle = std::stoull(values[4], nullptr, 10);
-        m_cputimes.back()->total =
-            m_cputimes.back()->user + m_cputimes.back()->nice + m_cputimes.back()->system + m_cputimes.back()->idle;
+      // Another module already read the values shared with us
+      if (snapshot == m_cputimes) {
+        return false;
       }
-    } catch (const std::ios_base::failure& e) {
+
+      m_cputimes_prev = move(m_cputimes);
+      m_cputimes = move(snapshot);
+    } catch (const system_error& e) {
       m_log.err("Failed to read CPU values (what: %s)", e.what());
+      return false;
     }
 
-    return !m_cputimes.empty();
+    return !m_cputimes->cores.empty();
   }
 
   float cpu_module::get_load(size_t core) const {
-    if (m_cputimes.empty() || m_cputimes_prev.empty()) {
+    if (!m_cputimes || !m_cputimes_prev) {
       return 0;
-    } else if (core >= m_cputimes.size() || core >= m_cputimes_prev.size()) {
+    } else if (core >= m_cputimes->cores.size() || core >= m_cputimes_prev->cores.size()) {
       return 0;
     }
 
-    auto& last = m_cputimes[core];
-    auto& prev = m_cputimes_prev[core];
+    auto& last = m_cputimes->cores[core];
+    auto& prev = m_cputimes_prev->cores[core];
 
-    auto last_idle = last->idle;
-    auto prev_idle = prev->idle;
+    auto last_idle = last.idle;
+    auto prev_idle = prev.idle;
 
-    auto diff = last->total - prev->total;
+    auto diff = last.total - prev.total;
 
     if (diff == 0) {
       return 0;
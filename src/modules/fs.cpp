@@ -6,7 +6,6 @@
 #include "drawtypes/progressbar.hpp"
 #include "drawtypes/ramp.hpp"
 #include "utils/math.hpp"
-#include "utils/mtab.hpp"
 #include "utils/string.hpp"
 
 #include "modules/meta/base.inl"
@@ -51,48 +50,45 @@ namespace modules {
   }
 
   /**
-   * Update values by reading mtab entries
+   * Update values by reading the stats of the configured mounts
+   *
+   * The mount table is only parsed again after
+   * the kernel reported a change
    */
   bool fs_module::update() {
+    m_mountinfo.update();
     m_mounts.clear();
 
     struct statvfs buffer;
-    struct mntent* mnt = nullptr;
 
     for (auto&& mountpoint : m_mountpoints) {
       m_mounts.emplace_back(new fs_mount{mountpoint, false});
 
-      if (statvfs(mountpoint.c_str(), &buffer) == -1) {
+      auto entry = m_mountinfo.find(mountpoint);
+
+      if (entry == nullptr || statvfs(mountpoint.c_str(), &buffer) == -1) {
         continue;
       }
 
-      auto mtab = make_unique<mtab_util::reader>();
       auto& mount = m_mounts.back();
 
-      while (mtab->next(&mnt)) {
-        if (string{mnt->mnt_dir} != mountpoint) {
-          continue;
-        }
-
-        mount->mounted = true;
-        mount->mountpoint = mnt->mnt_dir;
-        mount->type = mnt->mnt_type;
-        mount->fsname = mnt->mnt_fsname;
+      mount->mounted = true;
+      mount->type = entry->type;
+      mount->fsname = entry->fsname;
 
-        auto b_total = buffer.f_bsize * buffer.f_blocks;
-        auto b_free = buffer.f_bsize * buffer.f_bfree;
-        auto b_used = b_total - b_free;
+      auto b_total = buffer.f_bsize * buffer.f_blocks;
+      auto b_free = buffer.f_bsize * buffer.f_bfree;
+      auto b_used = b_total - b_free;
 
-        mount->bytes_total = b_total;
-        mount->bytes_free = b_free;
-        mount->bytes_used = b_used;
+      mount->bytes_total = b_total;
+      mount->bytes_free = b_free;
+      mount->bytes_used = b_used;
 
-        mount->percentage_free = math_util::percentage<unsigned long long, float>(b_free, 0, b_total);
-        mount->percentage_used = math_util::percentage<unsigned long long, float>(b_used, 0, b_total);
+      mount->percentage_free = math_util::percentage<unsigned long long, float>(b_free, 0, b_total);
+      mount->percentage_used = math_util::percentage<unsigned long long, float>(b_used, 0, b_total);
 
-        mount->percentage_free_s = string_util::floatval(mount->percentage_free, 2, m_fixed, m_bar.locale);
-        mount->percentage_used_s = string_util::floatval(mount->percentage_used, 2, m_fixed, m_bar.locale);
-      }
+      mount->percentage_free_s = string_util::floatval(mount->percentage_free, 2, m_fixed, m_bar.locale);
+      mount->percentage_used_s = string_util::floatval(mount->percentage_used, 2, m_fixed, m_bar.locale);
     }
 
     return true;
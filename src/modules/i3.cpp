@@ -92,11 +92,19 @@ namespace modules {
     event_module::stop();
   }
 
+  int i3_module::get_file_descriptor() const {
+    return m_ipc ? m_ipc->get_event_socket_fd() : -1;
+  }
+
   bool i3_module::has_event() {
     try {
       m_ipc->handle_event();
       return true;
     } catch (const exception& err) {
+      // A closed socket stays readable, don't let it spin the reactor
+      if (m_reactor) {
+        throw module_error("Lost connection to the i3 event socket (" + string{err.what()} + ")");
+      }
       return false;
     }
   }
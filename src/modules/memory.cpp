@@ -1,5 +1,6 @@
 #include "modules/memory.hpp"
 
+#include "drawtypes/graph.hpp"
 #include "drawtypes/label.hpp"
 #include "drawtypes/progressbar.hpp"
 
@@ -14,8 +15,9 @@ namespace modules {
 
   void memory_module::setup() {
     m_interval = chrono::duration<double>(m_conf.get<float>(name(), "interval", 1));
+    m_sampler = proc_util::make_sampler();
 
-    m_formatter->add(DEFAULT_FORMAT, TAG_LABEL, {TAG_LABEL, TAG_BAR_USED, TAG_BAR_FREE});
+    m_formatter->add(DEFAULT_FORMAT, TAG_LABEL, {TAG_LABEL, TAG_BAR_USED, TAG_BAR_FREE, TAG_GRAPH_USED});
 
     if (m_formatter->has(TAG_BAR_USED)) {
       m_bars[memtype::USED] = load_progressbar(m_bar, m_conf, name(), TAG_BAR_USED);
@@ -23,6 +25,9 @@ namespace modules {
     if (m_formatter->has(TAG_BAR_FREE)) {
       m_bars[memtype::FREE] = load_progressbar(m_bar, m_conf, name(), TAG_BAR_FREE);
     }
+    if (m_formatter->has(TAG_GRAPH_USED)) {
+      m_graph_used = load_graph(m_bar, m_conf, name(), TAG_GRAPH_USED, 100.0f);
+    }
     if (m_formatter->has(TAG_LABEL)) {
       m_label = load_optional_label(m_conf, name(), TAG_LABEL, "%percentage_used%");
     }
@@ -31,31 +36,13 @@ namespace modules {
   bool memory_module::update() {
     float kb_total;
     float kb_avail;
-    // long kb_free;
 
     try {
-      std::ifstream in(PATH_MEMORY_INFO);
-      std::stringstream buffer;
-      string str, rdbuf;
-      int i = 0;
-
-      in.exceptions(in.failbit);
-
-      buffer.imbue(std::locale::classic());
-
-      while (std::getline(in, str) && i++ < 3) {
-        size_t off = str.find_first_of("1234567890", str.find(':'));
-        buffer << std::strtol(&str[off], nullptr, 10) << std::endl;
-      }
-
-      buffer >> rdbuf;
-      kb_total = std::atol(rdbuf.c_str());
-      buffer >> rdbuf;  // kb_free = std::atol(rdbuf.c_str());
-      buffer >> rdbuf;
-      kb_avail = std::atol(rdbuf.c_str());
-    } catch (const std::ios_base::failure& e) {
+      auto memory = m_sampler->memory();
+      kb_total = memory->total;
+      kb_avail = memory->available;
+    } catch (const system_error& e) {
       kb_total = 0;
-      // kb_free = 0;
       kb_avail = 0;
       m_log.err("Failed to read memory values (what: %s)", e.what());
     }
@@ -68,6 +55,10 @@ namespace modules {
 
     m_perc[memtype::USED] = 100 - m_perc[memtype::FREE];
 
+    if (m_graph_used) {
+      m_graph_used->add(m_perc[memtype::USED]);
+    }
+
     // replace tokens
     if (m_label) {
       m_label->reset_tokens();
@@ -97,6 +88,8 @@ namespace modules {
       builder->node(m_bars.at(memtype::USED)->output(m_perc.at(memtype::USED)));
     } else if (tag == TAG_BAR_FREE) {
       builder->node(m_bars.at(memtype::FREE)->output(m_perc.at(memtype::FREE)));
+    } else if (tag == TAG_GRAPH_USED) {
+      builder->node(m_graph_used->output());
     } else if (tag == TAG_LABEL) {
       builder->node(m_label);
     } else {
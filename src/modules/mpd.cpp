@@ -103,6 +103,11 @@ namespace modules {
     return m_mpd && m_mpd->connected();
   }
 
+  /**
+   * The module keeps its thread in reactor mode: besides the idle
+   * notifications on the socket, it has to reconnect while disconnected
+   * and advance the elapsed time while playing
+   */
   void mpd_module::idle() {
     if (connected()) {
       sleep(80ms);
@@ -2,6 +2,7 @@
 
 #include "drawtypes/animation.hpp"
 #include "drawtypes/label.hpp"
+#include "drawtypes/graph.hpp"
 #include "drawtypes/ramp.hpp"
 
 #include "modules/meta/base.inl"
@@ -17,6 +18,7 @@ namespace modules {
     // Load configuration values
     REQ_CONFIG_VALUE(name(), m_interface, "interface");
     GET_CONFIG_VALUE(name(), m_ping_nth_update, "ping-interval");
+    GET_CONFIG_VALUE(name(), m_ping_timeout, "ping-timeout");
     GET_CONFIG_VALUE(name(), m_udspeed_minwidth, "udspeed-minwidth");
     GET_CONFIG_VALUE(name(), m_accumulate, "accumulate-stats");
 
@@ -25,7 +27,8 @@ namespace modules {
     m_interval = chrono::duration<double>(m_conf.get<float>(name(), "interval", 1));
 
     // Add formats
-    m_formatter->add(FORMAT_CONNECTED, TAG_LABEL_CONNECTED, {TAG_RAMP_SIGNAL, TAG_RAMP_QUALITY, TAG_LABEL_CONNECTED});
+    m_formatter->add(FORMAT_CONNECTED, TAG_LABEL_CONNECTED,
+        {TAG_RAMP_SIGNAL, TAG_RAMP_QUALITY, TAG_GRAPH_DOWNSPEED, TAG_GRAPH_UPSPEED, TAG_LABEL_CONNECTED});
     m_formatter->add(FORMAT_DISCONNECTED, TAG_LABEL_DISCONNECTED, {TAG_LABEL_DISCONNECTED});
 
     // Create elements for format-connected
@@ -35,6 +38,12 @@ namespace modules {
     if (m_formatter->has(TAG_RAMP_QUALITY, FORMAT_CONNECTED)) {
       m_ramp_quality = load_ramp(m_conf, name(), TAG_RAMP_QUALITY);
     }
+    if (m_formatter->has(TAG_GRAPH_DOWNSPEED, FORMAT_CONNECTED)) {
+      m_graph_downspeed = load_graph(m_bar, m_conf, name(), TAG_GRAPH_DOWNSPEED);
+    }
+    if (m_formatter->has(TAG_GRAPH_UPSPEED, FORMAT_CONNECTED)) {
+      m_graph_upspeed = load_graph(m_bar, m_conf, name(), TAG_GRAPH_UPSPEED);
+    }
     if (m_formatter->has(TAG_LABEL_CONNECTED, FORMAT_CONNECTED)) {
       m_label[connection_state::CONNECTED] =
           load_optional_label(m_conf, name(), TAG_LABEL_CONNECTED, "%ifname% %local_ip%");
@@ -67,20 +76,81 @@ namespace modules {
       m_wired = make_unique<net::wired_network>(m_interface);
     };
 
+    // Test connectivity in the background, every nth interval
+    if (m_ping_nth_update > 0) {
+      m_probe = make_unique<net::connectivity_probe>(CONNECTION_TEST_IP, m_interval * m_ping_nth_update,
+          chrono::duration<double>(m_ping_timeout), bind(&network_module::on_probe_change, this));
+    }
+
+    // Values which aren't notified on link changes have to be polled
+    m_polling = m_wireless || m_ping_nth_update > 0 || m_graph_downspeed || m_graph_upspeed;
+
+    for (auto&& label : m_label) {
+      if (label.second && (label.second->has_token("%upspeed%") || label.second->has_token("%downspeed%"))) {
+        m_polling = true;
+      }
+    }
+
     // We only need to start the subthread if the packetloss animation is used
     if (m_animation_packetloss) {
       m_threads.emplace_back(thread(&network_module::subthread_routine, this));
     }
   }
 
+  /**
+   * Stop the connectivity probe before the module lock is
+   * taken, since its callback waits for the lock
+   */
+  void network_module::stop() {
+    if (m_probe) {
+      m_probe->stop();
+    }
+    timer_module::stop();
+  }
+
   void network_module::teardown() {
+    m_probe.reset();
     m_wireless.reset();
     m_wired.reset();
   }
 
+  /**
+   * Follow link and address changes on the shared event loop
+   *
+   * Interval updates are only scheduled when some of the values
+   * aren't notified: the traffic rates, the wireless signal and
+   * the connectivity test
+   */
+  void network_module::start() {
+    if (m_probe && running()) {
+      m_probe->start();
+    }
+
+    if (!m_reactor) {
+      return timer_module::start();
+    } else if (!running()) {
+      return;
+    }
+
+    try {
+      if (m_polling) {
+        timer_module::start();
+      } else {
+        std::lock_guard<concurrency_util::spin_lock> guard(m_lock);
+        {
+          if (update()) {
+            broadcast();
+          }
+        }
+      }
+      m_reactor->add_fd(this, get_network()->get_file_descriptor(), bind(&network_module::on_link_event, this));
+    } catch (const std::exception& err) {
+      halt(err.what());
+    }
+  }
+
   bool network_module::update() {
-    net::network* network =
-        m_wireless ? static_cast<net::network*>(m_wireless.get()) : static_cast<net::network*>(m_wired.get());
+    net::network* network{get_network()};
 
     if (!network->query(m_accumulate)) {
       m_log.warn("%s: Failed to query interface '%s'", name(), m_interface);
@@ -96,14 +166,31 @@ namespace modules {
       m_log.warn("%s: Error getting interface data (%s)", name(), err.what());
     }
 
+    if (m_graph_downspeed) {
+      m_graph_downspeed->add(network->downspeed_rate());
+    }
+    if (m_graph_upspeed) {
+      m_graph_upspeed->add(network->upspeed_rate());
+    }
+
+    refresh();
+
+    return true;
+  }
+
+  /**
+   * Update connection state and label contents
+   * from the last values of the interface
+   */
+  void network_module::refresh() {
+    net::network* network{get_network()};
+
     m_connected = network->connected();
 
-    // Ignore the first run
-    if (m_counter == -1) {
-      m_counter = 0;
-    } else if (m_ping_nth_update > 0 && m_connected && (++m_counter % m_ping_nth_update) == 0) {
-      m_packetloss = !network->ping();
-      m_counter = 0;
+    // The probe wakes the module up when its result changes
+    if (m_probe) {
+      m_probe->set_source(network->ip());
+      m_packetloss = m_connected && !m_probe->reachable();
     }
 
     auto upspeed = network->upspeed(m_udspeed_minwidth);
@@ -117,6 +204,11 @@ namespace modules {
       label->replace_token("%upspeed%", upspeed);
       label->replace_token("%downspeed%", downspeed);
 
+      if (m_probe) {
+        auto latency = m_probe->latency();
+        label->replace_token("%latency%", latency != -1 ? to_string(latency) + " ms" : "--");
+      }
+
       if (m_wired) {
         label->replace_token("%linkspeed%", m_wired->linkspeed());
       } else if (m_wireless) {
@@ -132,8 +224,6 @@ namespace modules {
     if (m_label[connection_state::PACKETLOSS]) {
       replace_tokens(m_label[connection_state::PACKETLOSS]);
     }
-
-    return true;
   }
 
   string network_module::get_format() const {
@@ -159,12 +249,71 @@ namespace modules {
       builder->node(m_ramp_signal->get_by_percentage(m_signal));
     } else if (tag == TAG_RAMP_QUALITY) {
       builder->node(m_ramp_quality->get_by_percentage(m_quality));
+    } else if (tag == TAG_GRAPH_DOWNSPEED) {
+      builder->node(m_graph_downspeed->output());
+    } else if (tag == TAG_GRAPH_UPSPEED) {
+      builder->node(m_graph_upspeed->output());
     } else {
       return false;
     }
     return true;
   }
 
+  /**
+   * Handle link and address notifications, redrawing
+   * the module without waiting for the next interval
+   */
+  void network_module::on_link_event() {
+    try {
+      std::lock_guard<concurrency_util::spin_lock> guard(m_lock);
+      {
+        if (!running() || !get_network()->process_events()) {
+          return;
+        }
+
+        // Without interval updates the other values are refreshed
+        // here, polling would sample the counters too early
+        if (m_polling) {
+          refresh();
+        } else if (!update()) {
+          return;
+        }
+
+        broadcast();
+      }
+    } catch (const std::exception& err) {
+      halt(err.what());
+    }
+  }
+
+  /**
+   * Redraw the module when the connectivity test result changed
+   *
+   * Only the derived values are refreshed, running the interval
+   * update early would cut the traffic sample short
+   */
+  void network_module::on_probe_change() {
+    try {
+      std::lock_guard<concurrency_util::spin_lock> guard(m_lock);
+      {
+        if (running()) {
+          refresh();
+          broadcast();
+        }
+      }
+    } catch (const std::exception& err) {
+      // Stopping the module from here would join the probe thread
+      m_log.err("%s: Failed to refresh after connectivity change (%s)", name(), err.what());
+    }
+  }
+
+  /**
+   * Get the adapter of the configured interface
+   */
+  net::network* network_module::get_network() const {
+    return m_wireless ? static_cast<net::network*>(m_wireless.get()) : static_cast<net::network*>(m_wired.get());
+  }
+
   void network_module::subthread_routine() {
     const chrono::milliseconds framerate{m_animation_packetloss->framerate()};
     const auto dur = chrono::duration<double>(framerate);
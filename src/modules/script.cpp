@@ -13,6 +13,8 @@ namespace modules {
   void script_module::setup() {
     REQ_CONFIG_VALUE(name(), m_exec, "exec");
     GET_CONFIG_VALUE(name(), m_tail, "tail");
+    GET_CONFIG_VALUE(name(), m_persistent, "persistent");
+    GET_CONFIG_VALUE(name(), m_latest, "tail-latest");
     GET_CONFIG_VALUE(name(), m_maxlen, "maxlen");
     GET_CONFIG_VALUE(name(), m_ellipsis, "ellipsis");
 
@@ -27,6 +29,11 @@ namespace modules {
 
     m_interval = chrono::duration<double>{m_conf.get<double>(name(), "interval", m_tail ? 0.0 : 5.0)};
 
+    // Poll the command through a long-lived shell instead of spawning one every interval
+    if (m_persistent && !m_tail) {
+      m_worker = make_unique<command_util::worker>(m_log);
+    }
+
     m_formatter->add(DEFAULT_FORMAT, TAG_LABEL, {TAG_OUTPUT, TAG_LABEL});
 
     if (m_formatter->has(TAG_LABEL)) {
@@ -41,6 +48,12 @@ namespace modules {
       m_log.warn("%s: Stopping shell command", name());
       m_command->terminate();
     }
+    if (m_worker) {
+      m_worker->kill();
+    }
+    if (m_dropped > 0) {
+      m_log.info("%s: Skipped %lu outdated line(s) of tail output", name(), m_dropped);
+    }
     wakeup();
     event_module::stop();
   }
@@ -75,7 +88,26 @@ namespace modules {
       return false;
     }
 
-    if ((m_output = m_command->readline()) == m_prev) {
+    m_output = m_command->readline();
+
+    // Render only the newest line when the script writes
+    // faster than we can keep up with
+    if (m_latest) {
+      string line;
+      size_t dropped{0U};
+
+      while (m_command->try_readline(line)) {
+        m_output.swap(line);
+        dropped++;
+      }
+
+      if (dropped > 0) {
+        m_dropped += dropped;
+        m_log.trace("%s: Skipped %lu outdated line(s) (total %lu)", name(), dropped, m_dropped);
+      }
+    }
+
+    if (m_output == m_prev) {
       return false;
     }
 
@@ -91,10 +123,20 @@ namespace modules {
 
     try {
       auto exec = string_util::replace_all(m_exec, "%counter%", to_string(++m_counter));
-      m_log.info("%s: Executing \"%s\"", name(), exec);
-      m_command = command_util::make_command(exec);
-      m_command->exec();
-      m_command->tail([&](string output) { m_output = output; });
+
+      if (m_worker) {
+        vector<string> lines;
+        m_log.trace("%s: Executing \"%s\" in worker shell", name(), exec);
+        if (m_worker->run(exec, lines) == -1) {
+          return false;
+        }
+        m_output = lines.empty() ? "" : lines.back();
+      } else {
+        m_log.info("%s: Executing \"%s\"", name(), exec);
+        m_command = command_util::make_command(exec);
+        m_command->exec();
+        m_command->tail([&](string output) { m_output = output; });
+      }
     } catch (const std::exception& err) {
       m_log.err("%s: %s", name(), err.what());
       throw module_error("Failed to execute command, stopping module...");
@@ -82,19 +82,49 @@ namespace modules {
     m_mixer.clear();
   }
 
+  /**
+   * Get the descriptors of all mixers and controls,
+   * used to follow them in reactor mode
+   */
+  vector<int> volume_module::get_file_descriptors() const {
+    vector<int> fds;
+
+    try {
+      for (auto&& m : m_mixer) {
+        if (m.second) {
+          auto mixer_fds = m.second->get_file_descriptors();
+          fds.insert(fds.end(), mixer_fds.begin(), mixer_fds.end());
+        }
+      }
+      for (auto&& c : m_ctrl) {
+        if (c.second) {
+          auto ctrl_fds = c.second->get_file_descriptors();
+          fds.insert(fds.end(), ctrl_fds.begin(), ctrl_fds.end());
+        }
+      }
+    } catch (const alsa_exception& e) {
+      m_log.err("%s: %s", name(), e.what());
+    }
+
+    return fds;
+  }
+
   bool volume_module::has_event() {
+    // The reactor only calls in once a descriptor is readable
+    int timeout{m_reactor ? 0 : 25};
+
     // Poll for mixer and control events
     try {
-      if (m_mixer[mixer::MASTER] && m_mixer[mixer::MASTER]->wait(25)) {
+      if (m_mixer[mixer::MASTER] && m_mixer[mixer::MASTER]->wait(timeout)) {
         return true;
       }
-      if (m_mixer[mixer::SPEAKER] && m_mixer[mixer::SPEAKER]->wait(25)) {
+      if (m_mixer[mixer::SPEAKER] && m_mixer[mixer::SPEAKER]->wait(timeout)) {
         return true;
       }
-      if (m_mixer[mixer::HEADPHONE] && m_mixer[mixer::HEADPHONE]->wait(25)) {
+      if (m_mixer[mixer::HEADPHONE] && m_mixer[mixer::HEADPHONE]->wait(timeout)) {
         return true;
       }
-      if (m_ctrl[control::HEADPHONE] && m_ctrl[control::HEADPHONE]->wait(25)) {
+      if (m_ctrl[control::HEADPHONE] && m_ctrl[control::HEADPHONE]->wait(timeout)) {
         return true;
       }
     } catch (const alsa_exception& e) {
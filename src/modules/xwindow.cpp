@@ -21,6 +21,7 @@ namespace modules {
       : m_connection(configure_connection().create<decltype(m_connection)>()), m_window(m_connection, win) {
     try {
       m_window.change_event_mask(XCB_EVENT_MASK_PROPERTY_CHANGE);
+      m_connection.properties().watch(m_window, this);
     } catch (const xpp::x::error::window& err) {
     }
   }
@@ -29,6 +30,8 @@ namespace modules {
    * Deconstruct window object
    */
   active_window::~active_window() {
+    m_connection.properties().unwatch(m_window, this);
+
     try {
       m_window.change_event_mask(XCB_EVENT_MASK_NO_EVENT);
     } catch (const xpp::x::error::window& err) {
@@ -47,12 +50,10 @@ namespace modules {
    *  _NET_WM_VISIBLE_NAME
    *  _NET_WM_NAME
    */
-  string active_window::title(xcb_ewmh_connection_t* ewmh) const {
+  string active_window::title() const {
     string title;
 
-    if (!(title = ewmh_util::get_visible_name(ewmh, m_window)).empty()) {
-      return title;
-    } else if (!(title = ewmh_util::get_wm_name(ewmh, m_window)).empty()) {
+    if (!(title = ewmh_util::get_window_title(m_connection, m_window)).empty()) {
       return title;
     } else if (!(title = icccm_util::get_wm_name(m_connection, m_window)).empty()) {
       return title;
@@ -97,6 +98,9 @@ namespace modules {
     // Make sure we get notified when root properties change
     m_connection.ensure_event_mask(m_connection.root(), XCB_EVENT_MASK_PROPERTY_CHANGE);
 
+    // Keep root properties in the shared cache
+    m_connection.properties().watch(m_connection.root(), this);
+
     // Connect with the event registry
     m_connection.attach_sink(this, SINK_PRIORITY_MODULE);
 
@@ -109,6 +113,7 @@ namespace modules {
    */
   void xwindow_module::teardown() {
     m_connection.detach_sink(this, SINK_PRIORITY_MODULE);
+    m_connection.properties().unwatch(m_connection.root(), this);
   }
 
   /**
@@ -132,14 +137,14 @@ namespace modules {
    * Update the currently active window and query its title
    */
   void xwindow_module::update() {
-    xcb_window_t win{ewmh_util::get_active_window(m_ewmh.get())};
+    xcb_window_t win{ewmh_util::get_active_window(m_connection)};
     string title;
 
     if (m_active && m_active->match(win)) {
-      title = m_active->title(m_ewmh.get());
+      title = m_active->title();
     } else if (win != XCB_NONE) {
       m_active = make_unique<active_window>(win);
-      title = m_active->title(m_ewmh.get());
+      title = m_active->title();
     } else {
       m_active.reset();
     }
@@ -88,6 +88,9 @@ namespace modules {
     // Make sure we get notified when root properties change
     window{m_connection, m_connection.root()}.ensure_event_mask(XCB_EVENT_MASK_PROPERTY_CHANGE);
 
+    // Keep root properties in the shared cache
+    m_connection.properties().watch(m_connection.root(), this);
+
     // Connect with the event registry
     m_connection.attach_sink(this, SINK_PRIORITY_MODULE);
   }
@@ -97,6 +100,7 @@ namespace modules {
    */
   void xworkspaces_module::teardown() {
     m_connection.detach_sink(this, SINK_PRIORITY_MODULE);
+    m_connection.properties().unwatch(m_connection.root(), this);
   }
 
   /**
@@ -119,14 +123,14 @@ namespace modules {
    * Fetch and parse data
    */
   void xworkspaces_module::update() {
-    auto current = ewmh_util::get_current_desktop(m_ewmh.get());
-    auto names = ewmh_util::get_desktop_names(m_ewmh.get());
+    vector<string> names;
     vector<position> viewports;
     size_t num{0};
     position pos;
 
+    auto current = ewmh_util::get_desktops(m_connection, names, m_monitorsupport ? &viewports : nullptr);
+
     if (m_monitorsupport) {
-      viewports = ewmh_util::get_desktop_viewports(m_ewmh.get());
       num = math_util::min(names.size(), viewports.size());
     } else {
       num = names.size();
@@ -238,7 +242,7 @@ namespace modules {
     uint32_t new_desktop{0};
     uint32_t min_desktop{0};
     uint32_t max_desktop{0};
-    uint32_t current_desktop{ewmh_util::get_current_desktop(m_ewmh.get())};
+    uint32_t current_desktop{ewmh_util::get_current_desktop(m_connection)};
 
     for (auto&& viewport : m_viewports) {
       for (auto&& desktop : viewport->desktops) {
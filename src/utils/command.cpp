@@ -1,12 +1,14 @@
 #include <sys/wait.h>
 #include <unistd.h>
 #include <csignal>
+#include <random>
 #include <utility>
 
 #include "errors.hpp"
 #include "utils/command.hpp"
 #include "utils/io.hpp"
 #include "utils/process.hpp"
+#include "utils/string.hpp"
 
 POLYBAR_NS
 
@@ -18,6 +20,8 @@ namespace command_util {
     if (pipe(m_stdout) != 0) {
       throw command_strerror("Failed to allocate output stream");
     }
+
+    m_reader = make_unique<io_util::line_reader>(m_stdout[PIPE_READ]);
   }
 
   command::~command() {
@@ -41,56 +45,44 @@ namespace command_util {
 
   /**
    * Execute the command
+   *
+   * The child is spawned with posix_spawn, which doesn't copy
+   * the page tables of our (rather large) address space
    */
   int command::exec(bool wait_for_completion) {
-    if ((m_forkpid = fork()) == -1) {
-      throw system_error("Failed to fork process");
-    }
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
 
-    if (process_util::in_forked_process(m_forkpid)) {
-      if (dup2(m_stdin[PIPE_READ], STDIN_FILENO) == -1) {
-        throw command_strerror("Failed to redirect stdin in child process");
-      }
-      if (dup2(m_stdout[PIPE_WRITE], STDOUT_FILENO) == -1) {
-        throw command_strerror("Failed to redirect stdout in child process");
-      }
-      if (dup2(m_stdout[PIPE_WRITE], STDERR_FILENO) == -1) {
-        throw command_strerror("Failed to redirect stderr in child process");
-      }
-
-      // Close file descriptors that won't be used by the child
-      if ((m_stdin[PIPE_READ] = close(m_stdin[PIPE_READ])) == -1) {
-        throw command_strerror("Failed to close fd");
-      }
-      if ((m_stdin[PIPE_WRITE] = close(m_stdin[PIPE_WRITE])) == -1) {
-        throw command_strerror("Failed to close fd");
-      }
-      if ((m_stdout[PIPE_READ] = close(m_stdout[PIPE_READ])) == -1) {
-        throw command_strerror("Failed to close fd");
-      }
-      if ((m_stdout[PIPE_WRITE] = close(m_stdout[PIPE_WRITE])) == -1) {
-        throw command_strerror("Failed to close fd");
-      }
+    // Redirect stdin/stdout/stderr to the pipes and close
+    // the file descriptors that won't be used by the child
+    posix_spawn_file_actions_adddup2(&actions, m_stdin[PIPE_READ], STDIN_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, m_stdout[PIPE_WRITE], STDOUT_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, m_stdout[PIPE_WRITE], STDERR_FILENO);
+    posix_spawn_file_actions_addclose(&actions, m_stdin[PIPE_READ]);
+    posix_spawn_file_actions_addclose(&actions, m_stdin[PIPE_WRITE]);
+    posix_spawn_file_actions_addclose(&actions, m_stdout[PIPE_READ]);
+    posix_spawn_file_actions_addclose(&actions, m_stdout[PIPE_WRITE]);
 
-      // Make sure SIGTERM is raised
-      process_util::unblock_signal(SIGTERM);
+    try {
+      m_forkpid = process_util::spawn_sh(m_cmd.c_str(), &actions);
+      posix_spawn_file_actions_destroy(&actions);
+    } catch (const system_error&) {
+      posix_spawn_file_actions_destroy(&actions);
+      throw;
+    }
 
-      setpgid(m_forkpid, 0);
-      process_util::exec_sh(m_cmd.c_str());
-    } else {
-      // Close file descriptors that won't be used by the parent
-      if ((m_stdin[PIPE_READ] = close(m_stdin[PIPE_READ])) == -1) {
-        throw command_strerror("Failed to close fd");
-      }
-      if ((m_stdout[PIPE_WRITE] = close(m_stdout[PIPE_WRITE])) == -1) {
-        throw command_strerror("Failed to close fd");
-      }
+    // Close file descriptors that won't be used by the parent
+    if ((m_stdin[PIPE_READ] = close(m_stdin[PIPE_READ])) == -1) {
+      throw command_strerror("Failed to close fd");
+    }
+    if ((m_stdout[PIPE_WRITE] = close(m_stdout[PIPE_WRITE])) == -1) {
+      throw command_strerror("Failed to close fd");
+    }
 
-      if (wait_for_completion) {
-        auto status = wait();
-        m_forkpid = -1;
-        return status;
-      }
+    if (wait_for_completion) {
+      auto status = wait();
+      m_forkpid = -1;
+      return status;
     }
 
     return EXIT_SUCCESS;
@@ -154,7 +146,10 @@ namespace command_util {
    * end until the stream is closed
    */
   void command::tail(callback<string> cb) {
-    io_util::tail(m_stdout[PIPE_READ], move(cb));
+    string line;
+    while (readline(line)) {
+      cb(line);
+    }
   }
 
   /**
@@ -169,8 +164,28 @@ namespace command_util {
    * Read a line from the commands output stream
    */
   string command::readline() {
+    string line;
+    readline(line);
+    return line;
+  }
+
+  /**
+   * Read a line from the commands output stream
+   *
+   * Returns false once the stream is closed
+   */
+  bool command::readline(string& line) {
+    std::lock_guard<concurrency_util::spin_lock> lck(m_pipelock);
+    return m_reader->readline(line);
+  }
+
+  /**
+   * Read a line from the commands output stream if
+   * one is available without blocking
+   */
+  bool command::try_readline(string& line) {
     std::lock_guard<concurrency_util::spin_lock> lck(m_pipelock);
-    return io_util::readline(m_stdout[PIPE_READ]);
+    return m_reader->try_readline(line);
   }
 
   /**
@@ -200,6 +215,118 @@ namespace command_util {
   int command::get_exit_status() {
     return m_forkstatus;
   }
+
+  worker::worker(const logger& logger) : m_log(logger) {
+    std::random_device rd;
+    m_marker = "__polybar_worker_" + to_string(getpid()) + "_" + to_string(rd()) + "__";
+  }
+
+  /**
+   * Run command in the worker shell and collect its output lines
+   *
+   * The command is passed through eval as a single quoted string,
+   * so syntax errors can't break the framing of the protocol.
+   * Returns -1 once the worker has been killed
+   */
+  int worker::run(const string& cmd, vector<string>& output) {
+    output.clear();
+
+    if (m_killed) {
+      return -1;
+    } else if (!is_running()) {
+      start();
+    }
+
+    string quoted{"'" + string_util::replace_all(cmd, "'", "'\\''") + "'"};
+    string job{"( eval " + quoted + "\n) </dev/null 2>&1; printf '%s %d\\n' '" + m_marker + "' $?\n"};
+
+    if (io_util::write(m_shell->get_stdin(PIPE_WRITE), job) != job.size()) {
+      terminate();
+      throw command_strerror("Failed to write to worker shell");
+    }
+
+    string line;
+
+    while (m_shell->readline(line)) {
+      auto pos = line.find(m_marker);
+
+      if (pos == string::npos) {
+        output.emplace_back(move(line));
+        continue;
+      }
+
+      // Output without a trailing newline ends up on the marker line
+      if (pos > 0) {
+        output.emplace_back(line.substr(0, pos));
+      }
+
+      return std::atoi(line.c_str() + pos + m_marker.size());
+    }
+
+    terminate();
+
+    if (m_killed) {
+      output.clear();
+      return -1;
+    }
+
+    throw command_error("Worker shell exited unexpectedly");
+  }
+
+  /**
+   * Check if the worker shell is alive
+   */
+  bool worker::is_running() {
+    return m_shell && m_shell->is_running();
+  }
+
+  /**
+   * Stop the worker shell
+   *
+   * Only to be called from the thread running commands,
+   * other threads use kill() instead
+   */
+  void worker::terminate() {
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    if (m_shell) {
+      m_shell->terminate();
+      m_shell.reset();
+    }
+  }
+
+  /**
+   * Kill the worker shell from another thread
+   *
+   * The shell is only signalled, a pending run() returns once it
+   * sees the end of its output and frees the shell itself
+   */
+  void worker::kill() {
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    m_killed = true;
+
+    if (m_shell && m_shell->get_pid() > 0) {
+      killpg(m_shell->get_pid(), SIGTERM);
+    }
+  }
+
+  /**
+   * Start the worker shell
+   */
+  void worker::start() {
+    m_log.trace("worker: Starting shell");
+
+    auto shell = make_command("exec /bin/sh");
+    shell->exec(false);
+
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_shell = move(shell);
+
+    if (m_killed) {
+      killpg(m_shell->get_pid(), SIGTERM);
+    }
+  }
 }
 
 POLYBAR_NS_END
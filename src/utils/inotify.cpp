@@ -91,6 +91,16 @@ namespace inotify_util {
     return event;
   }
 
+  /**
+   * Discard all pending events without blocking,
+   * including those queued for a removed watch
+   */
+  void inotify_watch::drain() {
+    char buffer[1024];
+    while (poll(0) && read(m_fd, buffer, sizeof(buffer)) > 0) {
+    }
+  }
+
   /**
    * Wait for matching event
    */
@@ -105,6 +115,13 @@ namespace inotify_util {
     return m_path;
   }
 
+  /**
+   * Get the inotify file descriptor
+   */
+  int inotify_watch::get_file_descriptor() const {
+    return m_fd;
+  }
+
   watch_t make_watch(string path) {
     di::injector<watch_t> injector = di::make_injector(di::bind<>().to(path));
     return injector.create<watch_t>();
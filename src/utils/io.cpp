@@ -2,8 +2,10 @@
 #include <poll.h>
 #include <sys/stat.h>
 #include <unistd.h>
+#include <algorithm>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 
 #include "errors.hpp"
 #include "utils/io.hpp"
@@ -82,12 +84,9 @@ namespace io_util {
   }
 
   void tail(int read_fd, const function<void(string)>& callback) {
-    int bytes_read;
-    while (true) {
-      auto line = io_util::readline(read_fd, bytes_read);
-      if (bytes_read <= 0) {
-        break;
-      }
+    line_reader reader{read_fd};
+    string line;
+    while (reader.readline(line)) {
       callback(line);
     }
   }
@@ -119,6 +118,152 @@ namespace io_util {
     size_t bytes = ::write(write_fd, end, 1);
     return bytes > 0;
   }
+
+  line_reader::line_reader(int fd, size_t capacity) : m_fd(fd), m_buffer(capacity > 0 ? capacity : 1) {}
+
+  /**
+   * Read the next line, blocking until one is complete
+   *
+   * A partial line left when the stream is closed is returned
+   * as the last line. Returns false once all data is consumed
+   */
+  bool line_reader::readline(string& line) {
+    while (!extract(line)) {
+      if (m_eof || !fill()) {
+        return extract_remainder(line);
+      }
+    }
+    return true;
+  }
+
+  /**
+   * Read the next line without blocking
+   *
+   * Only reads from the descriptor while it is readable.
+   * Returns false if no complete line is available yet
+   */
+  bool line_reader::try_readline(string& line) {
+    while (!extract(line)) {
+      if (m_eof) {
+        return extract_remainder(line);
+      } else if (!poll(m_fd, POLLIN | POLLHUP, 0)) {
+        return false;
+      } else if (!fill()) {
+        return extract_remainder(line);
+      }
+    }
+    return true;
+  }
+
+  /**
+   * Check if the end of the stream has been reached
+   */
+  bool line_reader::eof() const {
+    return m_eof;
+  }
+
+  /**
+   * Get the number of buffered bytes not yet returned
+   */
+  size_t line_reader::buffered() const {
+    return m_size;
+  }
+
+  /**
+   * Get the descriptor being read
+   */
+  int line_reader::get_fd() const {
+    return m_fd;
+  }
+
+  /**
+   * Move the first complete line out of the buffer
+   */
+  bool line_reader::extract(string& line) {
+    const size_t capacity{m_buffer.size()};
+    const char* data{m_buffer.data()};
+    const size_t first{std::min(m_size, capacity - m_head)};
+    const size_t second{m_size - first};
+
+    // The buffered data wraps around the end of the
+    // ring, so the newline is searched for in two parts
+    const char* nl{static_cast<const char*>(memchr(data + m_head, '\n', first))};
+    size_t length{0U};
+
+    if (nl != nullptr) {
+      length = nl - (data + m_head);
+      line.assign(data + m_head, length);
+    } else if (second > 0 && (nl = static_cast<const char*>(memchr(data, '\n', second))) != nullptr) {
+      length = first + (nl - data);
+      line.assign(data + m_head, first);
+      line.append(data, nl - data);
+    } else {
+      return false;
+    }
+
+    m_head = (m_head + length + 1) % capacity;
+    m_size -= length + 1;
+
+    if (m_size == 0) {
+      m_head = 0;
+    }
+
+    return true;
+  }
+
+  /**
+   * Move the trailing data without newline out of the buffer
+   */
+  bool line_reader::extract_remainder(string& line) {
+    if (m_size == 0) {
+      return false;
+    }
+
+    const size_t first{std::min(m_size, m_buffer.size() - m_head)};
+    line.assign(m_buffer.data() + m_head, first);
+    line.append(m_buffer.data(), m_size - first);
+    m_head = m_size = 0;
+    return true;
+  }
+
+  /**
+   * Read as much as fits in the free space following the buffered data
+   *
+   * Returns false when the stream is closed
+   */
+  bool line_reader::fill() {
+    if (m_size == m_buffer.size()) {
+      grow();
+    }
+
+    const size_t capacity{m_buffer.size()};
+    const size_t tail{(m_head + m_size) % capacity};
+    const size_t space{tail >= m_head ? capacity - tail : m_head - tail};
+
+    ssize_t bytes;
+    while ((bytes = ::read(m_fd, m_buffer.data() + tail, space)) == -1 && errno == EINTR) {
+    }
+
+    if (bytes <= 0) {
+      m_eof = true;
+      return false;
+    }
+
+    m_size += bytes;
+    return true;
+  }
+
+  /**
+   * Double the capacity, moving the buffered data to the front
+   */
+  void line_reader::grow() {
+    vector<char> buffer(m_buffer.size() * 2);
+    const size_t first{std::min(m_size, m_buffer.size() - m_head)};
+    std::copy_n(m_buffer.begin() + m_head, first, buffer.begin());
+    std::copy_n(m_buffer.begin(), m_size - first, buffer.begin() + first);
+    m_buffer.swap(buffer);
+    m_head = 0;
+  }
 }
 
 POLYBAR_NS_END
@@ -0,0 +1,156 @@
+#include <poll.h>
+#include <cstring>
+
+#include "utils/mtab.hpp"
+
+POLYBAR_NS
+
+namespace mtab_util {
+  namespace {
+    /**
+     * Get the next space separated field of the line
+     */
+    const char* next_field(const char* pos, const char* eol, const char*& field_end) {
+      field_end = static_cast<const char*>(memchr(pos, ' ', eol - pos));
+      if (field_end == nullptr) {
+        field_end = eol;
+      }
+      return field_end < eol ? field_end + 1 : eol;
+    }
+
+    /**
+     * Decode the octal escapes used for blanks
+     * and backslashes in mountinfo fields
+     */
+    string unescape(const char* pos, const char* end) {
+      string value;
+      value.reserve(end - pos);
+
+      while (pos < end) {
+        if (*pos == '\\' && end - pos >= 4 && pos[1] >= '0' && pos[1] <= '3' && pos[2] >= '0' && pos[2] <= '7' &&
+            pos[3] >= '0' && pos[3] <= '7') {
+          value += static_cast<char>((pos[1] - '0') << 6 | (pos[2] - '0') << 3 | (pos[3] - '0'));
+          pos += 4;
+        } else {
+          value += *pos++;
+        }
+      }
+
+      return value;
+    }
+  }
+
+  /**
+   * Parse /proc/self/mountinfo into an index by mountpoint
+   *
+   * The lines have the format
+   *   id parent major:minor root mountpoint options [optional...] - type source superoptions
+   *
+   * For stacked mounts the last entry is the visible one, so later
+   * lines replace earlier ones. Returns false if the data ends
+   * in the middle of a line
+   */
+  bool parse_mountinfo(const char* data, size_t size, mount_index& mounts) {
+    const char* end{data + size};
+    const char* pos{data};
+
+    mounts.clear();
+
+    while (pos < end) {
+      const char* eol{static_cast<const char*>(memchr(pos, '\n', end - pos))};
+
+      if (eol == nullptr) {
+        return false;
+      }
+
+      const char* field{pos};
+      const char* field_end{nullptr};
+      const char* mountpoint{nullptr};
+      const char* mountpoint_end{nullptr};
+
+      // Skip id, parent id, device and root
+      for (int i = 0; i < 5 && field < eol; i++) {
+        mountpoint = field;
+        field = next_field(field, eol, field_end);
+        mountpoint_end = field_end;
+      }
+
+      // Skip the options up to the separator
+      while (field < eol) {
+        const char* separator{field};
+        field = next_field(field, eol, field_end);
+        if (field_end - separator == 1 && *separator == '-') {
+          break;
+        }
+      }
+
+      if (field < eol && mountpoint != nullptr) {
+        const char* type{field};
+        const char* type_end{nullptr};
+        const char* fsname{next_field(type, eol, type_end)};
+        const char* fsname_end{nullptr};
+        next_field(fsname, eol, fsname_end);
+
+        auto& entry = mounts[unescape(mountpoint, mountpoint_end)];
+        entry.type = unescape(type, type_end);
+        entry.fsname = unescape(fsname, fsname_end);
+      }
+
+      pos = eol + 1;
+    }
+
+    return true;
+  }
+
+  mountinfo::mountinfo(string path) : m_file(move(path), 16384) {}
+
+  /**
+   * Read the mount table again if it has changed
+   *
+   * Returns true if the index was updated
+   */
+  bool mountinfo::update() {
+    if (m_reads > 0 && !changed()) {
+      return false;
+    }
+
+    read();
+    return true;
+  }
+
+  /**
+   * Get the entry mounted at given path
+   */
+  const mount_entry* mountinfo::find(const string& mountpoint) const {
+    auto it = m_mounts.find(mountpoint);
+    return it != m_mounts.end() ? &it->second : nullptr;
+  }
+
+  size_t mountinfo::reads() const {
+    return m_reads;
+  }
+
+  /**
+   * Check for pending mount table change notifications
+   *
+   * The notification is consumed by polling, so
+   * a change is only reported once
+   */
+  bool mountinfo::changed() const {
+    struct pollfd fds {};
+    fds.fd = m_file.get_file_descriptor();
+    fds.events = POLLPRI;
+
+    return poll(&fds, 1, 0) > 0 && (fds.revents & (POLLPRI | POLLERR)) != 0;
+  }
+
+  /**
+   * Parse the whole file
+   */
+  void mountinfo::read() {
+    parse_mountinfo(m_file.data(), m_file.read_all(), m_mounts);
+    m_reads++;
+  }
+}
+
+POLYBAR_NS_END
@@ -0,0 +1,291 @@
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+#include "config.hpp"
+#include "errors.hpp"
+#include "utils/factory.hpp"
+#include "utils/proc.hpp"
+
+POLYBAR_NS
+
+namespace proc_util {
+  namespace {
+    /**
+     * Parse unsigned integer, skipping leading blanks
+     */
+    const char* scan_number(const char* pos, const char* end, unsigned long long& value) {
+      while (pos < end && (*pos == ' ' || *pos == '\t')) {
+        pos++;
+      }
+
+      value = 0ULL;
+      while (pos < end && *pos >= '0' && *pos <= '9') {
+        value = value * 10 + static_cast<unsigned long long>(*pos++ - '0');
+      }
+
+      return pos;
+    }
+
+    /**
+     * Get the position following the next newline
+     */
+    const char* next_line(const char* pos, const char* end) {
+      auto nl = static_cast<const char*>(memchr(pos, '\n', end - pos));
+      return nl != nullptr ? nl + 1 : end;
+    }
+
+    /**
+     * Check if the line at pos starts with given prefix
+     */
+    bool starts_with(const char* pos, const char* end, const char* prefix, size_t length) {
+      return static_cast<size_t>(end - pos) >= length && memcmp(pos, prefix, length) == 0;
+    }
+  }
+
+  /**
+   * Parse the per core lines of /proc/stat
+   *
+   * Returns false unless the data reaches into the line following
+   * the core lines, since data ending at a line boundary may have
+   * been cut before the remaining cores
+   */
+  bool parse_stat(const char* data, size_t size, vector<cpu_time>& cores) {
+    const char* end{data + size};
+    const char* pos{data};
+
+    cores.clear();
+
+    while (pos < end && starts_with(pos, end, "cpu", 3)) {
+      const char* eol{static_cast<const char*>(memchr(pos, '\n', end - pos))};
+
+      if (eol == nullptr) {
+        return false;
+      }
+
+      // Skip the line with the accumulated values
+      if (pos[3] >= '0' && pos[3] <= '9') {
+        unsigned long long id;
+        cpu_time time;
+
+        pos = scan_number(pos + 3, eol, id);
+        pos = scan_number(pos, eol, time.user);
+        pos = scan_number(pos, eol, time.nice);
+        pos = scan_number(pos, eol, time.system);
+        scan_number(pos, eol, time.idle);
+
+        time.total = time.user + time.nice + time.system + time.idle;
+        cores.emplace_back(time);
+      }
+
+      pos = eol + 1;
+    }
+
+    // Too short to tell if another core line follows
+    return end - pos >= 3;
+  }
+
+  /**
+   * Parse /proc/meminfo
+   *
+   * Kernels older than 3.14 don't report MemAvailable,
+   * in which case it is estimated from free and cached memory
+   */
+  bool parse_meminfo(const char* data, size_t size, memory_snapshot& memory) {
+    const char* end{data + size};
+    const char* pos{data};
+
+    unsigned long long buffers{0ULL};
+    unsigned long long cached{0ULL};
+    bool has_available{false};
+
+    memory.total = memory.free = memory.available = 0ULL;
+
+    while (pos < end) {
+      if (starts_with(pos, end, "MemTotal:", 9)) {
+        scan_number(pos + 9, end, memory.total);
+      } else if (starts_with(pos, end, "MemFree:", 8)) {
+        scan_number(pos + 8, end, memory.free);
+      } else if (starts_with(pos, end, "MemAvailable:", 13)) {
+        scan_number(pos + 13, end, memory.available);
+        has_available = true;
+      } else if (starts_with(pos, end, "Buffers:", 8)) {
+        scan_number(pos + 8, end, buffers);
+      } else if (starts_with(pos, end, "Cached:", 7)) {
+        scan_number(pos + 7, end, cached);
+        break;
+      }
+
+      pos = next_line(pos, end);
+    }
+
+    if (!has_available) {
+      memory.available = memory.free + buffers + cached;
+    }
+
+    return memory.total > 0;
+  }
+
+  proc_file::proc_file(string path, size_t capacity) : m_path(move(path)), m_buffer(capacity) {}
+
+  proc_file::~proc_file() {
+    if (m_fd != -1) {
+      close(m_fd);
+    }
+  }
+
+  /**
+   * Read the beginning of the file into the buffer
+   *
+   * The file is opened on first use and kept open,
+   * procfs regenerates the contents on every read
+   */
+  size_t proc_file::read() {
+    open();
+
+    ssize_t bytes;
+    while ((bytes = pread(m_fd, m_buffer.data(), m_buffer.size(), 0)) == -1 && errno == EINTR) {
+    }
+
+    if (bytes == -1) {
+      throw system_error("Failed to read " + m_path);
+    }
+
+    return static_cast<size_t>(bytes);
+  }
+
+  /**
+   * Read the whole file into the buffer, growing it as needed
+   *
+   * Sequence files like /proc/self/mountinfo return about a page
+   * per read, so reading continues until the end of the file
+   */
+  size_t proc_file::read_all() {
+    open();
+
+    if (lseek(m_fd, 0, SEEK_SET) == -1) {
+      throw system_error("Failed to rewind " + m_path);
+    }
+
+    size_t size{0U};
+
+    while (true) {
+      if (size == m_buffer.size()) {
+        grow();
+      }
+
+      ssize_t bytes{::read(m_fd, m_buffer.data() + size, m_buffer.size() - size)};
+
+      if (bytes == -1 && errno == EINTR) {
+        continue;
+      } else if (bytes == -1) {
+        throw system_error("Failed to read " + m_path);
+      } else if (bytes == 0) {
+        break;
+      }
+
+      size += static_cast<size_t>(bytes);
+    }
+
+    return size;
+  }
+
+  /**
+   * Double the buffer size
+   */
+  void proc_file::grow() {
+    m_buffer.resize(m_buffer.size() * 2);
+  }
+
+  const char* proc_file::data() const {
+    return m_buffer.data();
+  }
+
+  size_t proc_file::capacity() const {
+    return m_buffer.size();
+  }
+
+  int proc_file::get_file_descriptor() const {
+    return m_fd;
+  }
+
+  /**
+   * Open the file on first use
+   */
+  void proc_file::open() {
+    if (m_fd == -1 && (m_fd = ::open(m_path.c_str(), O_RDONLY | O_CLOEXEC)) == -1) {
+      throw system_error("Failed to open " + m_path);
+    }
+  }
+
+  sampler::sampler(string stat_path, string meminfo_path) : m_stat(move(stat_path)), m_meminfo(move(meminfo_path)) {}
+
+  /**
+   * Get per core times
+   */
+  cpu_snapshot_t sampler::cpu(duration_t max_age) {
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    auto now = chrono::steady_clock::now();
+
+    if (m_cpu && now - m_cpu->time < max_age) {
+      return m_cpu;
+    }
+
+    auto snapshot = make_shared<cpu_snapshot>();
+    snapshot->cores.reserve(m_cpu ? m_cpu->cores.size() : 0U);
+    snapshot->time = now;
+
+    // Only the leading cpu lines are needed, the buffer
+    // grows until they fit, not to hold the whole file
+    while (true) {
+      size_t bytes{m_stat.read()};
+      if (parse_stat(m_stat.data(), bytes, snapshot->cores) || bytes < m_stat.capacity()) {
+        break;
+      }
+      m_stat.grow();
+    }
+
+    m_reads++;
+    m_cpu = move(snapshot);
+    return m_cpu;
+  }
+
+  /**
+   * Get memory values
+   */
+  memory_snapshot_t sampler::memory(duration_t max_age) {
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    auto now = chrono::steady_clock::now();
+
+    if (m_memory && now - m_memory->time < max_age) {
+      return m_memory;
+    }
+
+    auto snapshot = make_shared<memory_snapshot>();
+    snapshot->time = now;
+    parse_meminfo(m_meminfo.data(), m_meminfo.read(), *snapshot);
+
+    m_reads++;
+    m_memory = move(snapshot);
+    return m_memory;
+  }
+
+  /**
+   * Get the number of times the files have been read
+   */
+  size_t sampler::reads() const {
+    return m_reads;
+  }
+
+  /**
+   * Get the sampler shared by all modules
+   */
+  shared_ptr<sampler> make_sampler() {
+    return factory_util::generic_singleton<sampler>(string{PATH_CPU_INFO}, string{PATH_MEMORY_INFO});
+  }
+}
+
+POLYBAR_NS_END
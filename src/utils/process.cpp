@@ -1,5 +1,8 @@
 #include <sys/wait.h>
 #include <unistd.h>
+#include <csignal>
+
+extern char** environ;
 
 #include "errors.hpp"
 #include "utils/env.hpp"
@@ -40,6 +43,41 @@ namespace process_util {
     throw system_error("execvp() failed");
   }
 
+  /**
+   * Spawn command using shell without duplicating the address space
+   *
+   * The child is put in its own process group and starts with an
+   * empty signal mask, since the calling thread blocks SIGCHLD for
+   * the executor's signalfd and children must not inherit that
+   */
+  pid_t spawn_sh(const char* cmd, const posix_spawn_file_actions_t* actions) {
+    static const string shell{env_util::get("SHELL", "/bin/sh")};
+
+    posix_spawnattr_t attr;
+    sigset_t sigmask;
+    pid_t pid{-1};
+    int err{0};
+
+    sigemptyset(&sigmask);
+
+    posix_spawnattr_init(&attr);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETPGROUP | POSIX_SPAWN_SETSIGMASK);
+    posix_spawnattr_setpgroup(&attr, 0);
+    posix_spawnattr_setsigmask(&attr, &sigmask);
+
+    char* argv[]{const_cast<char*>(shell.c_str()), const_cast<char*>("-c"), const_cast<char*>(cmd), nullptr};
+    err = posix_spawnp(&pid, shell.c_str(), actions, &attr, argv, environ);
+
+    posix_spawnattr_destroy(&attr);
+
+    if (err != 0) {
+      errno = err;
+      throw system_error("posix_spawnp() failed");
+    }
+
+    return pid;
+  }
+
   /**
    * Wait for child process
    */
@@ -98,6 +98,13 @@ namespace socket_util {
 
     return fds[0].revents & events;
   }
+
+  /**
+   * Get the socket file descriptor
+   */
+  int unix_connection::get_file_descriptor() const {
+    return m_fd;
+  }
 }
 
 POLYBAR_NS_END
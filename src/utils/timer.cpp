@@ -0,0 +1,161 @@
+#include <algorithm>
+
+#include "utils/timer.hpp"
+
+POLYBAR_NS
+
+namespace timer_util {
+  constexpr size_t timer_wheel::SLOT_BITS;
+  constexpr size_t timer_wheel::SLOTS;
+  constexpr size_t timer_wheel::LEVELS;
+
+  /**
+   * Construct wheel starting at given tick
+   */
+  timer_wheel::timer_wheel(uint64_t now) : m_base(now) {}
+
+  /**
+   * Schedule timer to expire at given tick
+   */
+  void timer_wheel::add(size_t id, uint64_t deadline) {
+    insert(entry{id, deadline});
+  }
+
+  /**
+   * Unschedule timer
+   */
+  bool timer_wheel::remove(size_t id) {
+    for (size_t level = 0; level < LEVELS; level++) {
+      for (auto&& slot : m_slots[level]) {
+        auto it = std::find_if(slot.begin(), slot.end(), [&](const entry& e) { return e.id == id; });
+        if (it != slot.end()) {
+          slot.erase(it);
+          m_counts[level]--;
+          return true;
+        }
+      }
+    }
+    return false;
+  }
+
+  /**
+   * Expire all timers due at or before given tick
+   */
+  void timer_wheel::advance(uint64_t until, vector<size_t>& expired) {
+    while (m_base <= until) {
+      if (!size()) {
+        m_base = until + 1;
+        break;
+      }
+
+      size_t index = m_base & (SLOTS - 1);
+
+      // Move timers of the next block down once the lower level wraps
+      for (size_t level = 1; index == 0 && level < LEVELS; level++) {
+        size_t slot = (m_base >> (SLOT_BITS * level)) & (SLOTS - 1);
+        cascade(level, slot);
+        if (slot != 0) {
+          break;
+        }
+      }
+
+      for (auto&& e : m_slots[0][index]) {
+        expired.emplace_back(e.id);
+      }
+
+      m_counts[0] -= m_slots[0][index].size();
+      m_slots[0][index].clear();
+      m_base++;
+
+      // Skip to the next cascade when nothing is due before it
+      if (!m_counts[0]) {
+        m_base = std::min(until + 1, (m_base + SLOTS - 1) & ~uint64_t{SLOTS - 1});
+      }
+    }
+  }
+
+  /**
+   * Get the tick of the earliest scheduled timer
+   */
+  bool timer_wheel::next_deadline(uint64_t& deadline) const {
+    if (!size()) {
+      return false;
+    }
+
+    deadline = UINT64_MAX;
+
+    for (size_t k = 0; m_counts[0] && k < SLOTS; k++) {
+      if (!m_slots[0][(m_base + k) & (SLOTS - 1)].empty()) {
+        deadline = m_base + k;
+        break;
+      }
+    }
+
+    // Slots of the upper levels partition the time ahead, so the
+    // first non-empty slot holds the earliest timer of that level
+    for (size_t level = 1; level < LEVELS; level++) {
+      uint64_t block = m_base >> (SLOT_BITS * level);
+
+      for (size_t k = 1; m_counts[level] && k <= SLOTS; k++) {
+        auto& slot = m_slots[level][(block + k) & (SLOTS - 1)];
+
+        if (!slot.empty()) {
+          for (auto&& e : slot) {
+            deadline = std::min(deadline, std::max(e.deadline, m_base));
+          }
+          break;
+        }
+      }
+    }
+
+    return true;
+  }
+
+  /**
+   * Get the number of scheduled timers
+   */
+  size_t timer_wheel::size() const {
+    size_t count{0U};
+    for (auto&& n : m_counts) {
+      count += n;
+    }
+    return count;
+  }
+
+  /**
+   * Put entry in the slot matching its distance from the current tick
+   */
+  void timer_wheel::insert(const entry& e) {
+    uint64_t expires{std::max(e.deadline, m_base)};
+    uint64_t distance{expires - m_base};
+    size_t level{0U};
+
+    while (level < LEVELS - 1 && distance >> (SLOT_BITS * (level + 1))) {
+      level++;
+    }
+
+    // Timers beyond the range of the wheel are parked in the
+    // last slot and rescheduled when that slot is cascaded
+    if (distance >> (SLOT_BITS * LEVELS)) {
+      expires = m_base + (uint64_t{1} << (SLOT_BITS * LEVELS)) - 1;
+    }
+
+    m_slots[level][(expires >> (SLOT_BITS * level)) & (SLOTS - 1)].emplace_back(e);
+    m_counts[level]++;
+  }
+
+  /**
+   * Reinsert the entries of given slot relative to the current tick
+   */
+  void timer_wheel::cascade(size_t level, size_t slot) {
+    vector<entry> entries;
+    std::swap(entries, m_slots[level][slot]);
+    m_counts[level] -= entries.size();
+
+    for (auto&& e : entries) {
+      insert(e);
+    }
+  }
+}
+
+POLYBAR_NS_END
@@ -222,9 +222,23 @@ string connection::error_str(int error_code) {
 
 /**
  * Dispatch event through the registry
+ *
+ * Cached property values are invalidated before the
+ * sinks get a chance to read them
  */
 void connection::dispatch_event(const shared_ptr<xcb_generic_event_t>& evt) const {
+  if ((evt->response_type & ~0x80) == XCB_PROPERTY_NOTIFY) {
+    auto* notify = reinterpret_cast<const xcb_property_notify_event_t*>(evt.get());
+    m_properties.invalidate(notify->window, notify->atom);
+  }
   m_registry.dispatch(evt);
 }
 
+/**
+ * Get the window property cache
+ */
+property_cache& connection::properties() const {
+  return m_properties;
+}
+
 POLYBAR_NS_END
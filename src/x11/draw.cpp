@@ -22,6 +22,15 @@ namespace draw_util {
     fill(c, d, g, {x, y, w, h});
   }
 
+  /**
+   * Fill multiple regions of drawable in a single request
+   */
+  void fill(xcb_connection_t* c, xcb_drawable_t d, xcb_gcontext_t g, const vector<xcb_rectangle_t>& rects) {
+    if (!rects.empty()) {
+      xcb_poly_fill_rectangle(c, d, g, rects.size(), rects.data());
+    }
+  }
+
   /**
    * The xcb version of this function does not compose the correct request
    *
@@ -1,5 +1,6 @@
 #include "x11/ewmh.hpp"
 #include "components/types.hpp"
+#include "x11/connection.hpp"
 #include "x11/xutils.hpp"
 
 POLYBAR_NS
@@ -86,46 +87,146 @@ namespace ewmh_util {
   }
 
   vector<position> get_desktop_viewports(xcb_ewmh_connection_t* conn, int screen) {
+    return get_viewports_reply(conn, xcb_ewmh_get_desktop_viewport(conn, screen));
+  }
+
+  vector<string> get_desktop_names(xcb_ewmh_connection_t* conn, int screen) {
+    return get_names_reply(conn, xcb_ewmh_get_desktop_names(conn, screen));
+  }
+
+  /**
+   * Get the active window from the property cache
+   */
+  xcb_window_t get_active_window(connection& conn) {
+    auto prop = conn.properties().get(conn.root(), initialize()->_NET_ACTIVE_WINDOW);
+    return get_cardinal(*prop);
+  }
+
+  /**
+   * Get the current desktop from the property cache
+   */
+  uint32_t get_current_desktop(connection& conn) {
+    auto prop = conn.properties().get(conn.root(), initialize()->_NET_CURRENT_DESKTOP);
+    return get_cardinal(*prop);
+  }
+
+  /**
+   * Get current desktop, desktop names and (optionally) viewports
+   *
+   * Values missing from the property cache are requested
+   * together, so the whole state costs at most one round-trip
+   */
+  uint32_t get_desktops(connection& conn, vector<string>& names, vector<position>* viewports) {
+    auto ewmh = initialize();
+    vector<xcb_atom_t> atoms{ewmh->_NET_CURRENT_DESKTOP, ewmh->_NET_DESKTOP_NAMES};
+
+    if (viewports != nullptr) {
+      atoms.emplace_back(ewmh->_NET_DESKTOP_VIEWPORT);
+    }
+
+    auto props = conn.properties().get(conn.root(), atoms);
+
+    names = get_strings(*props[1]);
+
+    if (viewports != nullptr) {
+      viewports->clear();
+      viewports->reserve(props[2]->length / 2);
+
+      for (size_t n = 0; props[2]->format == 32 && n + 1 < props[2]->length; n += 2) {
+        viewports->emplace_back(position{static_cast<int16_t>(props[2]->values<uint32_t>()[n]),
+            static_cast<int16_t>(props[2]->values<uint32_t>()[n + 1])});
+      }
+    }
+
+    return get_cardinal(*props[0]);
+  }
+
+  /**
+   * Get the first non-empty value of _NET_WM_VISIBLE_NAME and _NET_WM_NAME
+   * from the property cache
+   */
+  string get_window_title(connection& conn, xcb_window_t win) {
+    auto ewmh = initialize();
+    auto props = conn.properties().get(win, {ewmh->_NET_WM_VISIBLE_NAME, ewmh->_NET_WM_NAME});
+
+    for (auto&& prop : props) {
+      if (prop->format == 8 && !prop->data.empty()) {
+        return prop->data.substr(0, prop->data.find('\0'));
+      }
+    }
+
+    return "";
+  }
+
+  /**
+   * Get first item of a 32-bit property
+   */
+  uint32_t get_cardinal(const property& prop) {
+    if (prop.format != 32 || prop.length == 0) {
+      return XCB_NONE;
+    }
+    return prop.values<uint32_t>()[0];
+  }
+
+  /**
+   * Split null separated list of strings
+   */
+  vector<string> get_strings(const property& prop) {
+    return get_strings(prop.data.data(), prop.data.size());
+  }
+
+  vector<position> get_viewports_reply(xcb_ewmh_connection_t* conn, xcb_get_property_cookie_t cookie) {
     vector<position> viewports;
     xcb_ewmh_get_desktop_viewport_reply_t reply;
 
-    if (!xcb_ewmh_get_desktop_viewport_reply(conn, xcb_ewmh_get_desktop_viewport(conn, screen), &reply, nullptr)) {
+    if (!xcb_ewmh_get_desktop_viewport_reply(conn, cookie, &reply, nullptr)) {
       return viewports;
     }
 
+    viewports.reserve(reply.desktop_viewport_len);
+
     for (size_t n = 0; n < reply.desktop_viewport_len; n++) {
       viewports.emplace_back(position{
           static_cast<int16_t>(reply.desktop_viewport[n].x), static_cast<int16_t>(reply.desktop_viewport[n].y)});
     }
 
+    xcb_ewmh_get_desktop_viewport_reply_wipe(&reply);
+
     return viewports;
   }
 
-  vector<string> get_desktop_names(xcb_ewmh_connection_t* conn, int screen) {
+  vector<string> get_names_reply(xcb_ewmh_connection_t* conn, xcb_get_property_cookie_t cookie) {
     vector<string> names;
     xcb_ewmh_get_utf8_strings_reply_t reply;
 
-    if (!xcb_ewmh_get_desktop_names_reply(conn, xcb_ewmh_get_desktop_names(conn, screen), &reply, nullptr)) {
+    if (!xcb_ewmh_get_desktop_names_reply(conn, cookie, &reply, nullptr)) {
       return names;
     }
 
-    char buffer[BUFSIZ];
-    size_t len{0};
+    names = get_strings(reply.strings, reply.strings_len);
+
+    xcb_ewmh_get_utf8_strings_reply_wipe(&reply);
 
-    for (size_t n = 0; n < reply.strings_len; n++) {
-      if (reply.strings[n] == '\0') {
-        names.emplace_back(buffer, len);
-        len = 0;
-      } else {
-        buffer[len++] = reply.strings[n];
+    return names;
+  }
+
+  vector<string> get_strings(const char* data, size_t len) {
+    vector<string> strings;
+    const char* begin{data};
+    const char* end{data + len};
+
+    for (const char* it = begin; it != end; it++) {
+      if (*it == '\0') {
+        strings.emplace_back(begin, it);
+        begin = it + 1;
       }
     }
 
-    if (len) {
-      names.emplace_back(buffer, len);
+    if (begin != end) {
+      strings.emplace_back(begin, end);
     }
 
-    return names;
+    return strings;
   }
 
   xcb_window_t get_active_window(xcb_ewmh_connection_t* conn, int screen) {
@@ -16,9 +16,6 @@ di::injector<unique_ptr<font_manager>> configure_font_manager() {
   return di::make_injector(configure_connection(), configure_logger());
 }
 
-array<char, XFT_MAXCHARS> xft_widths;
-array<wchar_t, XFT_MAXCHARS> xft_chars;
-
 void fonttype_deleter::operator()(fonttype* f) {
   if (f->xft != nullptr) {
     XftFontClose(xlib::get_display(), f->xft);
@@ -34,6 +31,10 @@ font_manager::font_manager(connection& conn, const logger& logger) : m_connectio
 }
 
 font_manager::~font_manager() {
+  m_logger.trace("font_manager: Font match cache hits: %lu, misses: %lu", m_cachestats.match_hits,
+      m_cachestats.match_misses);
+  m_logger.trace("font_manager: Glyph cache hits: %lu, misses: %lu", m_cachestats.glyph_hits,
+      m_cachestats.glyph_misses);
   XftColorFree(m_display, m_visual, m_colormap, &m_xftcolor);
   XFreeColormap(m_display, m_colormap);
   m_fonts.clear();
@@ -50,6 +51,9 @@ bool font_manager::load(const string& name, int8_t fontindex, int8_t offset_y) {
     m_logger.trace("font_manager: Add font '%s' to index '%i'", name, fontindex);
   }
 
+  // Previously resolved matches may prefer the new font
+  m_matches.clear();
+
   m_fonts.emplace(make_pair(fontindex, font_t{new fonttype(), fonttype_deleter{}}));
   m_fonts[fontindex]->offset_y = offset_y;
   m_fonts[fontindex]->ptr = 0;
@@ -96,56 +100,57 @@ void font_manager::set_preferred_font(int8_t index) {
   }
 }
 
-font_t& font_manager::match_char(uint16_t chr) {
+/**
+ * Get the font used to draw given character
+ *
+ * The resolved font is cached per preferred font index and
+ * codepoint, so repeated lookups cost a single hash lookup
+ */
+font_t& font_manager::match_char(uint32_t chr) {
   static font_t notfound;
+
+  uint64_t key{static_cast<uint64_t>(static_cast<uint8_t>(m_fontindex)) << 32 | chr};
+  auto cached = m_matches.find(key);
+
+  if (cached != m_matches.end()) {
+    m_cachestats.match_hits++;
+    return *cached->second;
+  }
+
+  m_cachestats.match_misses++;
+
+  font_t* match{&notfound};
+
   if (!m_fonts.empty()) {
+    auto iter = m_fonts.end();
     if (m_fontindex != DEFAULT_FONT_INDEX && size_t(m_fontindex) <= m_fonts.size()) {
-      auto iter = m_fonts.find(m_fontindex);
-      if (iter != m_fonts.end() && has_glyph(iter->second, chr)) {
-        return iter->second;
-      }
+      iter = m_fonts.find(m_fontindex);
     }
-    for (auto& font : m_fonts) {
-      if (has_glyph(font.second, chr)) {
-        return font.second;
+    if (iter != m_fonts.end() && has_glyph(iter->second, chr)) {
+      match = &iter->second;
+    } else {
+      for (auto& font : m_fonts) {
+        if (has_glyph(font.second, chr)) {
+          match = &font.second;
+          break;
+        }
       }
     }
   }
-  return notfound;
+
+  m_matches.emplace(key, match);
+
+  return *match;
 }
 
-uint8_t font_manager::char_width(font_t& font, uint16_t chr) {
+/**
+ * Get the advance width of given character
+ */
+uint16_t font_manager::char_width(font_t& font, uint32_t chr) {
   if (!font) {
     return 0;
   }
-
-  if (font->xft == nullptr) {
-    if (static_cast<size_t>(chr - font->char_min) < font->width_lut.size()) {
-      return font->width_lut[chr - font->char_min].character_width;
-    } else {
-      return font->width;
-    }
-  }
-
-  auto index = chr % XFT_MAXCHARS;
-  while (xft_chars[index] != 0 && xft_chars[index] != chr) {
-    index = (index + 1) % XFT_MAXCHARS;
-  }
-
-  if (!xft_chars[index]) {
-    XGlyphInfo gi;
-    FT_UInt glyph = XftCharIndex(m_display, font->xft, (FcChar32)chr);
-    XftFontLoadGlyphs(m_display, font->xft, FcFalse, &glyph, 1);
-    XftGlyphExtents(m_display, font->xft, &glyph, 1, &gi);
-    XftFontUnloadGlyphs(m_display, font->xft, &glyph, 1);
-    xft_chars[index] = chr;
-    xft_widths[index] = gi.xOff;
-    return gi.xOff;
-  } else if (xft_chars[index] == chr) {
-    return xft_widths[index];
-  }
-
-  return 0;
+  return lookup_glyph(font, chr).width;
 }
 
 XftColor font_manager::xftcolor() {
@@ -189,6 +194,13 @@ void font_manager::set_gcontext_font(xcb_gcontext_t gc, xcb_font_t font) {
   m_connection.change_gc(gc, XCB_GC_FONT, values);
 }
 
+/**
+ * Get the glyph and font match cache counters
+ */
+const glyph_cache_stats& font_manager::cache_stats() const {
+  return m_cachestats;
+}
+
 bool font_manager::open_xcb_font(font_t& fontptr, string fontname) {
   try {
     font xfont(m_connection, m_connection.generate_id());
@@ -227,21 +239,42 @@ bool font_manager::open_xcb_font(font_t& fontptr, string fontname) {
   return false;
 }
 
-bool font_manager::has_glyph(font_t& font, uint16_t chr) {
+bool font_manager::has_glyph(font_t& font, uint32_t chr) {
+  return lookup_glyph(font, chr).exists;
+}
+
+/**
+ * Get the cached glyph info of given character,
+ * querying the font the first time it's requested
+ */
+glyph_info& font_manager::lookup_glyph(font_t& font, uint32_t chr) {
+  auto cached = font->glyphs.find(chr);
+
+  if (cached != font->glyphs.end()) {
+    m_cachestats.glyph_hits++;
+    return cached->second;
+  }
+
+  m_cachestats.glyph_misses++;
+
+  glyph_info glyph{};
+
   if (font->xft != nullptr) {
-    return static_cast<bool>(XftCharExists(m_display, font->xft, (FcChar32)chr));
+    XGlyphInfo gi;
+    FT_UInt index = XftCharIndex(m_display, font->xft, (FcChar32)chr);
+    XftFontLoadGlyphs(m_display, font->xft, FcFalse, &index, 1);
+    XftGlyphExtents(m_display, font->xft, &index, 1, &gi);
+    XftFontUnloadGlyphs(m_display, font->xft, &index, 1);
+    glyph.exists = static_cast<bool>(XftCharExists(m_display, font->xft, (FcChar32)chr));
+    glyph.width = gi.xOff;
+  } else if (chr >= font->char_min && static_cast<size_t>(chr - font->char_min) < font->width_lut.size()) {
+    glyph.width = font->width_lut[chr - font->char_min].character_width;
+    glyph.exists = chr <= font->char_max && glyph.width != 0;
   } else {
-    if (chr < font->char_min || chr > font->char_max) {
-      return false;
-    }
-    if (static_cast<size_t>(chr - font->char_min) >= font->width_lut.size()) {
-      return false;
-    }
-    if (font->width_lut[chr - font->char_min].character_width == 0) {
-      return false;
-    }
-    return true;
+    glyph.width = font->width;
   }
+
+  return font->glyphs.emplace(chr, glyph).first->second;
 }
 
 POLYBAR_NS_END
@@ -0,0 +1,180 @@
+#include "x11/properties.hpp"
+
+POLYBAR_NS
+
+/**
+ * Construct cache for given connection
+ */
+property_cache::property_cache(xcb_connection_t* conn) : m_connection(conn) {}
+
+/**
+ * Start caching properties of given window
+ *
+ * The caller is responsible for selecting
+ * XCB_EVENT_MASK_PROPERTY_CHANGE on the window
+ */
+void property_cache::watch(xcb_window_t win, const void* owner) {
+  std::lock_guard<std::mutex> guard(m_lock);
+  m_watched[win].emplace(owner);
+}
+
+/**
+ * Stop caching properties of given window once
+ * all owners are gone and drop its entries
+ */
+void property_cache::unwatch(xcb_window_t win, const void* owner) {
+  std::lock_guard<std::mutex> guard(m_lock);
+
+  auto it = m_watched.find(win);
+  if (it == m_watched.end()) {
+    return;
+  }
+
+  it->second.erase(owner);
+
+  if (!it->second.empty()) {
+    return;
+  }
+
+  m_watched.erase(it);
+  m_generation++;
+
+  for (auto entry = m_properties.begin(); entry != m_properties.end();) {
+    if (static_cast<xcb_window_t>(entry->first >> 32) == win) {
+      entry = m_properties.erase(entry);
+    } else {
+      entry++;
+    }
+  }
+}
+
+/**
+ * Get property value
+ */
+property_t property_cache::get(xcb_window_t win, xcb_atom_t atom) {
+  return get(win, vector<xcb_atom_t>{atom}).front();
+}
+
+/**
+ * Get multiple property values of the same window
+ *
+ * Properties missing from the cache are requested in a
+ * single round-trip. Values are only stored if no event
+ * invalidated the cache while the requests were in flight
+ */
+vector<property_t> property_cache::get(xcb_window_t win, const vector<xcb_atom_t>& atoms) {
+  vector<property_t> result(atoms.size());
+  vector<size_t> missing;
+  uint64_t generation;
+  bool watched;
+
+  {
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    for (size_t i = 0; i < atoms.size(); i++) {
+      auto it = m_properties.find(make_key(win, atoms[i]));
+      if (it != m_properties.end()) {
+        result[i] = it->second;
+        m_hits++;
+      } else {
+        missing.emplace_back(i);
+        m_misses++;
+      }
+    }
+
+    generation = m_generation;
+    watched = m_watched.find(win) != m_watched.end();
+  }
+
+  if (missing.empty()) {
+    return result;
+  }
+
+  vector<xcb_atom_t> requested(missing.size());
+
+  for (size_t i = 0; i < missing.size(); i++) {
+    requested[i] = atoms[missing[i]];
+  }
+
+  auto values = fetch(win, requested);
+
+  for (size_t i = 0; i < missing.size(); i++) {
+    result[missing[i]] = move(values[i]);
+  }
+
+  if (watched) {
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    if (generation == m_generation) {
+      for (auto&& i : missing) {
+        m_properties[make_key(win, atoms[i])] = result[i];
+      }
+    }
+  }
+
+  return result;
+}
+
+/**
+ * Request property values from the server in a single round-trip
+ */
+vector<property_t> property_cache::fetch(xcb_window_t win, const vector<xcb_atom_t>& atoms) {
+  vector<xcb_get_property_cookie_t> cookies(atoms.size());
+  vector<property_t> values(atoms.size());
+
+  for (size_t i = 0; i < atoms.size(); i++) {
+    cookies[i] = xcb_get_property(m_connection, false, win, atoms[i], XCB_GET_PROPERTY_TYPE_ANY, 0, UINT32_MAX);
+  }
+
+  for (size_t i = 0; i < atoms.size(); i++) {
+    auto value = make_shared<property>();
+    auto* reply = xcb_get_property_reply(m_connection, cookies[i], nullptr);
+
+    if (reply != nullptr) {
+      value->type = reply->type;
+      value->format = reply->format;
+      value->length = reply->value_len;
+      value->data.assign(static_cast<const char*>(xcb_get_property_value(reply)),
+          static_cast<size_t>(xcb_get_property_value_length(reply)));
+    }
+
+    free(reply);
+    values[i] = value;
+  }
+
+  return values;
+}
+
+/**
+ * Drop cached property value
+ */
+void property_cache::invalidate(xcb_window_t win, xcb_atom_t atom) {
+  std::lock_guard<std::mutex> guard(m_lock);
+  m_properties.erase(make_key(win, atom));
+  m_generation++;
+}
+
+/**
+ * Get the number of values served from the cache
+ */
+size_t property_cache::hits() const {
+  std::lock_guard<std::mutex> guard(m_lock);
+  return m_hits;
+}
+
+/**
+ * Get the number of values requested from the server
+ */
+size_t property_cache::misses() const {
+  std::lock_guard<std::mutex> guard(m_lock);
+  return m_misses;
+}
+
+/**
+ * Create cache key for given window property
+ */
+uint64_t property_cache::make_key(xcb_window_t win, xcb_atom_t atom) {
+  return static_cast<uint64_t>(win) << 32 | atom;
+}
+
+POLYBAR_NS_END
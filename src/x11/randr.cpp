@@ -45,26 +45,58 @@ namespace randr_util {
 
   /**
    * Create a list of all available randr outputs
+   *
+   * The output and crtc info requests are pipelined so that
+   * scanning the outputs costs two round-trips regardless of count
    */
   vector<monitor_t> get_monitors(connection& conn, xcb_window_t root, bool connected_only) {
     vector<monitor_t> monitors;
-    auto outputs = conn.get_screen_resources(root).outputs();
+    auto resources = conn.get_screen_resources(root);
+    auto timestamp = resources->config_timestamp;
+    vector<xcb_randr_output_t> outputs{resources.outputs().begin(), resources.outputs().end()};
 
-    for (auto it = outputs.begin(); it != outputs.end(); it++) {
-      try {
-        auto info = conn.get_output_info(*it);
-        if (info->crtc == XCB_NONE) {
-          continue;
-        }
-        if (connected_only && info->connection != XCB_RANDR_CONNECTION_CONNECTED) {
-          continue;
+    vector<xcb_randr_get_output_info_cookie_t> output_cookies(outputs.size());
+    vector<xcb_randr_get_output_info_reply_t*> output_replies(outputs.size());
+    vector<xcb_randr_get_crtc_info_cookie_t> crtc_cookies(outputs.size());
+    xcb_generic_error_t* err{nullptr};
+
+    for (size_t i = 0; i < outputs.size(); i++) {
+      output_cookies[i] = xcb_randr_get_output_info(conn, outputs[i], timestamp);
+    }
+
+    for (size_t i = 0; i < outputs.size(); i++) {
+      // Errors (BadOutput) are ignored, the output is simply skipped
+      auto* info = output_replies[i] = xcb_randr_get_output_info_reply(conn, output_cookies[i], &err);
+      free(err);
+      err = nullptr;
+
+      if (info == nullptr || info->crtc == XCB_NONE) {
+        continue;
+      } else if (connected_only && info->connection != XCB_RANDR_CONNECTION_CONNECTED) {
+        continue;
+      }
+
+      crtc_cookies[i] = xcb_randr_get_crtc_info(conn, info->crtc, timestamp);
+    }
+
+    for (size_t i = 0; i < outputs.size(); i++) {
+      auto* info = output_replies[i];
+
+      if (info != nullptr && crtc_cookies[i].sequence) {
+        auto* crtc = xcb_randr_get_crtc_info_reply(conn, crtc_cookies[i], &err);
+        free(err);
+        err = nullptr;
+
+        if (crtc != nullptr) {
+          auto name = reinterpret_cast<const char*>(xcb_randr_get_output_info_name(info));
+          string output_name{name, name + xcb_randr_get_output_info_name_length(info)};
+          monitors.emplace_back(make_monitor(outputs[i], output_name, crtc->width, crtc->height, crtc->x, crtc->y));
         }
-        auto crtc = conn.get_crtc_info(info->crtc);
-        string name{info.name().begin(), info.name().end()};
-        monitors.emplace_back(make_monitor(*it, name, crtc->width, crtc->height, crtc->x, crtc->y));
-      } catch (const xpp::randr::error::bad_crtc&) {
-      } catch (const xpp::randr::error::bad_output&) {
+
+        free(crtc);
       }
+
+      free(info);
     }
 
     // clang-format off
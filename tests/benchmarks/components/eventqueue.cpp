@@ -0,0 +1,111 @@
+#include <moodycamel/blockingconcurrentqueue.h>
+#include <cstring>
+#include <thread>
+
+#include "components/event_queue.cpp"
+#include "utils/time.hpp"
+
+using namespace polybar;
+
+/**
+ * Queue entry used before payloads were moved out-of-line
+ */
+struct legacy_event {
+  uint8_t type{0};
+  char data[256]{'\0'};
+};
+
+/**
+ * Single blocking queue used before the priority lanes
+ */
+struct legacy_queue {
+  moodycamel::BlockingConcurrentQueue<legacy_event> queue;
+
+  void enqueue(const legacy_event& evt) {
+    queue.enqueue(evt);
+  }
+  void dequeue(legacy_event& evt) {
+    queue.wait_dequeue(evt);
+  }
+};
+
+template <typename Queue, typename Entry, typename Make, typename Consume>
+long run(size_t producers, size_t iterations, Make make, Consume consume) {
+  Queue queue;
+
+  return time_util::measure([&] {
+    vector<std::thread> threads;
+
+    for (size_t p = 0; p < producers; p++) {
+      threads.emplace_back([&, p] {
+        for (size_t i = 0; i < iterations; i++) {
+          queue.enqueue(make(p * iterations + i));
+        }
+      });
+    }
+
+    Entry evt;
+    for (size_t i = 0; i < producers * iterations; i++) {
+      queue.dequeue(evt);
+      consume(evt);
+    }
+
+    for (auto&& t : threads) {
+      t.join();
+    }
+  });
+}
+
+void report(const char* name, size_t count, long elapsed) {
+  std::printf("eventqueue: %-22s %lu events in %ld us (%.2f M events/s)\n", name, count, elapsed,
+      static_cast<double>(count) / elapsed);
+}
+
+int main() {
+  const size_t producers{4};
+  const size_t iterations{250000};
+  const size_t count{producers * iterations};
+  const string action{"#workspaces.click.3 i3-msg workspace 3; notify-send switched"};
+
+  // Stored and taken the same way as in eventloop::make() and forward_event()
+  event_payloads payloads;
+  size_t received{0};
+
+  // Module broadcast storm
+  report("update (legacy)", count, run<legacy_queue, legacy_event>(producers, iterations,
+                                        [](size_t) {
+                                          legacy_event evt{};
+                                          evt.type = static_cast<uint8_t>(event_type::UPDATE);
+                                          return evt;
+                                        },
+                                        [&](const legacy_event& evt) { received += evt.type; }));
+
+  report("update (lanes)", count, run<event_queue, event>(producers, iterations,
+                                       [](size_t) {
+                                         return event{static_cast<uint8_t>(event_type::UPDATE)};
+                                       },
+                                       [&](const event& evt) { received += evt.type; }));
+
+  // Click/IPC storm
+  report("input (legacy)", count, run<legacy_queue, legacy_event>(producers, iterations,
+                                       [&](size_t) {
+                                         legacy_event evt{};
+                                         evt.type = static_cast<uint8_t>(event_type::INPUT);
+                                         snprintf(evt.data, sizeof(evt.data), "%s", action.c_str());
+                                         return evt;
+                                       },
+                                       [&](const legacy_event& evt) { received += strlen(evt.data); }));
+
+  report("input (lanes)", count, run<event_queue, event>(producers, iterations,
+                                      [&](size_t) {
+                                        input_event data{action, std::chrono::steady_clock::now()};
+                                        return event{static_cast<uint8_t>(event_type::INPUT), false,
+                                            payloads.store(move(data))};
+                                      },
+                                      [&](const event& evt) { received += payloads.take(evt.payload).data.size(); }));
+
+  std::printf("eventqueue: entry size %lu bytes (legacy %lu bytes), %lu payloads left\n", sizeof(event),
+      sizeof(legacy_event), payloads.size());
+
+  return received > 0 ? 0 : 1;
+}
@@ -0,0 +1,39 @@
+#include "components/logger.cpp"
+#include "components/parser.cpp"
+#include "utils/string.cpp"
+#include "utils/time.hpp"
+
+int main() {
+  using namespace polybar;
+
+  // clang-format off
+  const string module{
+    "%{A1:i3-msg workspace 1:}%{B#3f3f3f u#fba922 +u} 1 \xef\x84\xa0 %{B- -u}%{A}"
+    "%{A1:i3-msg workspace 2:} 2 \xef\x84\xa1 %{A}"
+    "%{F#55aa55}cpu%{F-} 12% %{u#4bffdc +u}\xe2\x96\x81\xe2\x96\x83\xe2\x96\x85%{-u} "
+    "%{F#e60053 T2}\xef\x80\x97%{T- F-} 2016-11-20 %{O10}%{B#e60053} 13:37:00 %{B-} "
+  };
+  // clang-format on
+
+  string markup{"%{l}"};
+  while (markup.size() < 2048) {
+    markup += module;
+  }
+
+  logger log{loglevel::NONE};
+  bar_settings bar;
+  drawlist output;
+  parser parser{log, bar};
+
+  const size_t iterations{20000};
+
+  auto elapsed = time_util::measure([&] {
+    for (size_t i = 0; i < iterations; i++) {
+      parser(markup, output);
+    }
+  });
+
+  double megabytes{static_cast<double>(markup.size() * iterations) / 1e6};
+  std::printf("parser: %lu bytes x %lu iterations in %ld us (%.1f MB/s)\n", markup.size(), iterations,
+      static_cast<long>(elapsed), megabytes / (elapsed / 1e6));
+}
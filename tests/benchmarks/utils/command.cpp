@@ -0,0 +1,103 @@
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <chrono>
+#include <fstream>
+#include <thread>
+
+#include "components/logger.cpp"
+#include "utils/command.cpp"
+#include "utils/env.cpp"
+#include "utils/io.cpp"
+#include "utils/process.cpp"
+#include "utils/string.cpp"
+#include "utils/time.hpp"
+
+using namespace polybar;
+
+/**
+ * Spawn the way command::exec did before, using fork
+ */
+void fork_exec(const char* cmd) {
+  int out[2];
+  if (pipe(out) != 0) {
+    throw system_error("pipe() failed");
+  }
+
+  pid_t pid{fork()};
+
+  if (process_util::in_forked_process(pid)) {
+    dup2(out[PIPE_WRITE], STDOUT_FILENO);
+    close(out[PIPE_READ]);
+    close(out[PIPE_WRITE]);
+    setpgid(0, 0);
+    process_util::exec_sh(cmd);
+  }
+
+  close(out[PIPE_WRITE]);
+  process_util::wait_for_completion(pid);
+  close(out[PIPE_READ]);
+}
+
+/**
+ * Spawn using command_util (posix_spawn)
+ */
+void spawn_exec(const char* cmd) {
+  command_util::make_command(cmd)->exec();
+}
+
+long rss_kb() {
+  std::ifstream in{"/proc/self/status"};
+  string line;
+  while (std::getline(in, line)) {
+    if (line.compare(0, 6, "VmRSS:") == 0) {
+      return std::atol(line.substr(6).c_str());
+    }
+  }
+  return 0;
+}
+
+long minor_faults() {
+  struct rusage usage {};
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_minflt;
+}
+
+/**
+ * Spawn 100 commands per second while the parent keeps
+ * writing to its heap, like the bar does while rendering
+ */
+void run(const char* name, void (*spawn)(const char*), vector<char>& ballast) {
+  const size_t spawns{100};
+  const auto interval = std::chrono::milliseconds{10};
+  const size_t page{static_cast<size_t>(sysconf(_SC_PAGESIZE))};
+
+  long faults{minor_faults()};
+  long rss{rss_kb()};
+  long slowest{0};
+  long total{0};
+
+  for (size_t i = 0; i < spawns; i++) {
+    auto start = std::chrono::steady_clock::now();
+    auto elapsed = time_util::measure([&] { spawn("true"); });
+    total += elapsed;
+    slowest = std::max(slowest, static_cast<long>(elapsed));
+
+    for (size_t offset = i % page; offset < ballast.size(); offset += page) {
+      ballast[offset]++;
+    }
+
+    std::this_thread::sleep_until(start + interval);
+  }
+
+  std::printf("command: %-6s %lu spawns, avg %ld us, max %ld us, %ld minor faults, rss %+ld kB\n", name, spawns,
+      total / static_cast<long>(spawns), slowest, minor_faults() - faults, rss_kb() - rss);
+}
+
+int main() {
+  // Simulate the resident size of a running bar
+  vector<char> ballast(128 * 1024 * 1024, 1);
+
+  run("fork", fork_exec, ballast);
+  run("spawn", spawn_exec, ballast);
+}
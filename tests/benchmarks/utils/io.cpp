@@ -0,0 +1,73 @@
+#include <unistd.h>
+#include <thread>
+
+#include "utils/io.cpp"
+#include "utils/string.cpp"
+#include "utils/time.hpp"
+
+using namespace polybar;
+
+/**
+ * Feed lines through a pipe the way a chatty tail
+ * script does and consume them with the given reader
+ */
+template <typename Reader>
+long run(size_t lines, const string& line, Reader read) {
+  int fds[2];
+  if (pipe(fds) != 0) {
+    throw system_error("pipe() failed");
+  }
+
+  long elapsed{time_util::measure([&] {
+    std::thread writer([&] {
+      string chunk;
+      for (size_t i = 0; i < lines; i++) {
+        chunk += line + "\n";
+        if (chunk.size() >= 4096 || i + 1 == lines) {
+          io_util::write(fds[1], chunk);
+          chunk.clear();
+        }
+      }
+      close(fds[1]);
+    });
+
+    size_t received{read(fds[0])};
+    writer.join();
+
+    if (received != lines) {
+      std::printf("io: expected %lu lines, got %lu\n", lines, received);
+    }
+  })};
+
+  close(fds[0]);
+  return elapsed;
+}
+
+void report(const char* name, size_t lines, long elapsed) {
+  std::printf("io: %-10s %lu lines in %ld us (%.2f M lines/s)\n", name, lines, elapsed,
+      static_cast<double>(lines) / elapsed);
+}
+
+int main() {
+  const size_t lines{200000};
+  const string line{"%{F#f00} 42%{F-} 1.2 GHz 3.4 GiB eth0 up 12.3 MiB/s"};
+
+  report("bytewise", lines, run(lines, line, [](int fd) {
+    size_t count{0};
+    int bytes_read{0};
+    while (io_util::readline(fd, bytes_read), bytes_read > 0) {
+      count++;
+    }
+    return count;
+  }));
+
+  report("buffered", lines, run(lines, line, [](int fd) {
+    size_t count{0};
+    string buffer;
+    io_util::line_reader reader{fd};
+    while (reader.readline(buffer)) {
+      count++;
+    }
+    return count;
+  }));
+}
@@ -0,0 +1,91 @@
+#include <unistd.h>
+#include <cstdlib>
+#include <thread>
+
+#include "components/executor.cpp"
+#include "components/logger.cpp"
+#include "utils/command.cpp"
+#include "utils/env.cpp"
+#include "utils/io.cpp"
+#include "utils/process.cpp"
+#include "utils/string.cpp"
+
+int main() {
+  using namespace polybar;
+
+  logger log{loglevel::NONE};
+
+  char tmpl[]{"/tmp/polybar-executor.XXXXXX"};
+  const string dir{mkdtemp(tmpl)};
+
+  auto exists = [&](const string& name) { return access((dir + "/" + name).c_str(), F_OK) == 0; };
+
+  // Wait until the file exists or the timeout expires
+  auto await = [&](const string& name, int timeout_ms) {
+    for (int i = 0; i < timeout_ms / 10 && !exists(name); i++) {
+      std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    }
+    return exists(name);
+  };
+
+  "pending_limit"_test = [&] {
+    executor exec{log, 1, 2, executor::duration_t{0}};
+
+    // Nothing is dispatched before start()
+    expect(exec.exec("touch " + dir + "/p1"));
+    expect(exec.exec("touch " + dir + "/p2"));
+    expect(!exec.exec("touch " + dir + "/p3"));
+
+    exec.start();
+
+    expect(await("p1", 2000));
+    expect(await("p2", 2000));
+    expect(!exists("p3"));
+
+    // The queue has drained
+    expect(exec.exec("touch " + dir + "/p4"));
+    expect(await("p4", 2000));
+  };
+
+  "reaping"_test = [&] {
+    executor exec{log, 1, 8, executor::duration_t{0}};
+    exec.start();
+
+    // Only one command runs at a time, the slot is freed once it has been reaped
+    expect(exec.exec("sleep 0.2; touch " + dir + "/r1"));
+    expect(exec.exec("touch " + dir + "/r2"));
+
+    expect(await("r2", 2000));
+    expect(exists("r1"));
+  };
+
+  "timeout_escalation"_test = [&] {
+    executor exec{log, 1, 8, executor::duration_t{0}};
+    exec.start();
+
+    // Ignores SIGTERM, so it has to be killed after the grace period
+    auto start = std::chrono::steady_clock::now();
+    expect(exec.exec("trap '' TERM; sleep 5; touch " + dir + "/t1", executor::duration_t{100}));
+    expect(exec.exec("touch " + dir + "/t2"));
+
+    expect(await("t2", 4000));
+    expect(!exists("t1"));
+    expect(std::chrono::steady_clock::now() - start >= std::chrono::seconds{1});
+  };
+
+  "default_timeout"_test = [&] {
+    executor exec{log, 1, 8, executor::duration_t{100}};
+    exec.start();
+
+    expect(exec.exec("sleep 5; touch " + dir + "/d1"));
+    expect(exec.exec("touch " + dir + "/d2"));
+
+    expect(await("d2", 2000));
+    expect(!exists("d1"));
+  };
+
+  for (auto&& name : {"p1", "p2", "p4", "r1", "r2", "t2", "d2"}) {
+    unlink((dir + "/" + name).c_str());
+  }
+  rmdir(dir.c_str());
+}
@@ -0,0 +1,43 @@
+#include "utils/cache.hpp"
+
+int main() {
+  using namespace polybar;
+
+  "find"_test = [] {
+    cache_util::lru_cache<int, string> cache{4};
+    expect(cache.find(1) == nullptr);
+    cache.insert(1, "one");
+    expect(cache.find(1) != nullptr);
+    expect(*cache.find(1) == "one");
+    expect(cache.hits() == size_t{2});
+    expect(cache.misses() == size_t{1});
+  };
+
+  "insert"_test = [] {
+    cache_util::lru_cache<int, string> cache{4};
+    cache.insert(1, "one");
+    cache.insert(1, "uno");
+    expect(cache.size() == size_t{1});
+    expect(*cache.find(1) == "uno");
+  };
+
+  "evict"_test = [] {
+    cache_util::lru_cache<int, int> cache{2};
+    cache.insert(1, 10);
+    cache.insert(2, 20);
+    cache.find(1);
+    cache.insert(3, 30);
+    expect(cache.size() == size_t{2});
+    expect(cache.find(2) == nullptr);
+    expect(*cache.find(1) == 10);
+    expect(*cache.find(3) == 30);
+  };
+
+  "clear"_test = [] {
+    cache_util::lru_cache<int, int> cache{2};
+    cache.insert(1, 10);
+    cache.clear();
+    expect(cache.size() == size_t{0});
+    expect(cache.find(1) == nullptr);
+  };
+}
@@ -0,0 +1,48 @@
+#include "utils/history.hpp"
+
+int main() {
+  using namespace polybar;
+
+  "push"_test = [] {
+    history_util::ring_buffer<int> history{3};
+    expect(history.empty());
+    history.push(1);
+    history.push(2);
+    expect(history.size() == size_t{2});
+    expect(history[0] == 1);
+    expect(history[1] == 2);
+    expect(history.back() == 2);
+    expect(!history.full());
+  };
+
+  "overwrite"_test = [] {
+    history_util::ring_buffer<int> history{3};
+    for (int i = 1; i <= 5; i++) {
+      history.push(i);
+    }
+    expect(history.full());
+    expect(history.size() == size_t{3});
+    expect(history[0] == 3);
+    expect(history[1] == 4);
+    expect(history[2] == 5);
+    expect(history.back() == 5);
+  };
+
+  "clear"_test = [] {
+    history_util::ring_buffer<int> history{2};
+    history.push(1);
+    history.push(2);
+    history.clear();
+    expect(history.empty());
+    history.push(3);
+    expect(history.size() == size_t{1});
+    expect(history[0] == 3);
+  };
+
+  "empty_capacity"_test = [] {
+    history_util::ring_buffer<int> history{0};
+    history.push(1);
+    expect(history.empty());
+    expect(history.capacity() == size_t{0});
+  };
+}
@@ -0,0 +1,84 @@
+#include <unistd.h>
+
+#include "utils/io.cpp"
+#include "utils/string.cpp"
+
+int main() {
+  using namespace polybar;
+
+  "readline"_test = [] {
+    int fds[2];
+    expect(pipe(fds) == 0);
+    io_util::write(fds[1], "foo\nbar\n\nbaz");
+    close(fds[1]);
+
+    io_util::line_reader reader{fds[0]};
+    string line;
+    expect(reader.readline(line) && line == "foo");
+    expect(reader.readline(line) && line == "bar");
+    expect(reader.readline(line) && line.empty());
+    expect(reader.readline(line) && line == "baz");
+    expect(!reader.readline(line));
+    expect(reader.eof());
+    close(fds[0]);
+  };
+
+  "try_readline"_test = [] {
+    int fds[2];
+    expect(pipe(fds) == 0);
+
+    io_util::line_reader reader{fds[0]};
+    string line;
+    expect(!reader.try_readline(line));
+
+    io_util::write(fds[1], "partial");
+    expect(!reader.try_readline(line));
+    expect(reader.buffered() == size_t{7});
+
+    io_util::write(fds[1], " line\nnext\n");
+    expect(reader.try_readline(line) && line == "partial line");
+    expect(reader.try_readline(line) && line == "next");
+    expect(!reader.try_readline(line));
+    expect(!reader.eof());
+
+    close(fds[1]);
+    expect(!reader.try_readline(line));
+    expect(reader.eof());
+    close(fds[0]);
+  };
+
+  "wraparound"_test = [] {
+    int fds[2];
+    expect(pipe(fds) == 0);
+
+    io_util::line_reader reader{fds[0], 8};
+    string line;
+
+    for (int i = 0; i < 100; i++) {
+      io_util::write(fds[1], "ab\ncdefg\n" + to_string(i) + "\n");
+      expect(reader.readline(line) && line == "ab");
+      expect(reader.readline(line) && line == "cdefg");
+      expect(reader.readline(line) && line == to_string(i));
+    }
+
+    close(fds[1]);
+    close(fds[0]);
+  };
+
+  "grow"_test = [] {
+    int fds[2];
+    expect(pipe(fds) == 0);
+
+    string data(1000, 'x');
+    io_util::write(fds[1], "a\n" + data + "\nb\n");
+    close(fds[1]);
+
+    io_util::line_reader reader{fds[0], 4};
+    string line;
+    expect(reader.readline(line) && line == "a");
+    expect(reader.readline(line) && line == data);
+    expect(reader.readline(line) && line == "b");
+    expect(!reader.readline(line));
+    close(fds[0]);
+  };
+}
@@ -0,0 +1,80 @@
+#include <unistd.h>
+#include <fstream>
+
+#include "utils/mtab.cpp"
+#include "utils/proc.cpp"
+
+int main() {
+  using namespace polybar;
+
+  "parse_mountinfo"_test = [] {
+    string data{
+        "22 1 8:2 / / rw,relatime shared:1 - ext4 /dev/sda2 rw\n"
+        "36 22 8:3 / /home rw,relatime shared:2 master:1 - btrfs /dev/sda3 rw,ssd\n"
+        "41 22 0:35 / /mnt/my\\040disk rw - vfat /dev/sdb\\0401 rw\n"
+        "42 22 0:36 / /tmp rw - tmpfs tmpfs rw\n"
+        "43 42 0:37 / /tmp rw - ramfs none rw\n"};
+    mtab_util::mount_index mounts;
+
+    expect(mtab_util::parse_mountinfo(data.data(), data.size(), mounts));
+    expect(mounts.size() == size_t{4});
+    expect(mounts["/"].type == "ext4");
+    expect(mounts["/"].fsname == "/dev/sda2");
+    expect(mounts["/home"].type == "btrfs");
+    expect(mounts["/home"].fsname == "/dev/sda3");
+    expect(mounts["/mnt/my disk"].type == "vfat");
+    expect(mounts["/mnt/my disk"].fsname == "/dev/sdb 1");
+
+    // The last mount on top of another one is visible
+    expect(mounts["/tmp"].type == "ramfs");
+
+    // Cut in the middle of a line
+    expect(!mtab_util::parse_mountinfo(data.data(), 60, mounts));
+  };
+
+  "mountinfo"_test = [] {
+    char path[] = "/tmp/polybar-mtab-XXXXXX";
+    int fd = mkstemp(path);
+    expect(fd != -1);
+    close(fd);
+
+    std::ofstream(path) << "22 1 8:2 / / rw - ext4 /dev/sda2 rw\n";
+
+    mtab_util::mountinfo mounts{path};
+    expect(mounts.update());
+    expect(mounts.reads() == size_t{1});
+    expect(mounts.find("/") != nullptr);
+    expect(mounts.find("/")->fsname == "/dev/sda2");
+    expect(mounts.find("/home") == nullptr);
+
+    // Regular files never signal changes
+    expect(!mounts.update());
+    expect(mounts.reads() == size_t{1});
+
+    unlink(path);
+  };
+
+  "mountinfo_large"_test = [] {
+    char path[] = "/tmp/polybar-mtab-XXXXXX";
+    int fd = mkstemp(path);
+    expect(fd != -1);
+    close(fd);
+
+    // Larger than the initial buffer of the reader
+    {
+      std::ofstream file(path);
+      for (int i = 0; i < 1000; i++) {
+        file << i + 100 << " 22 0:" << i << " / /mnt/tmpfs" << i << " rw,relatime - tmpfs tmpfs rw\n";
+      }
+    }
+
+    mtab_util::mountinfo mounts{path};
+    expect(mounts.update());
+
+    for (int i = 0; i < 1000; i++) {
+      expect(mounts.find("/mnt/tmpfs" + to_string(i)) != nullptr);
+    }
+
+    unlink(path);
+  };
+}
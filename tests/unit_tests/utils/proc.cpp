@@ -0,0 +1,107 @@
+#include <unistd.h>
+#include <fstream>
+#include <thread>
+
+#include "utils/proc.cpp"
+
+int main() {
+  using namespace polybar;
+
+  "parse_stat"_test = [] {
+    string data{
+        "cpu  400 20 300 9000 10 0 5 0 0 0\n"
+        "cpu0 100 5 75 2250 3 0 1 0 0 0\n"
+        "cpu1 300 15 225 6750 7 0 4 0 0 0\n"
+        "intr 123456 0 9 0 0\n"};
+    vector<proc_util::cpu_time> cores;
+
+    expect(proc_util::parse_stat(data.data(), data.size(), cores));
+    expect(cores.size() == size_t{2});
+    expect(cores[0].user == 100ULL);
+    expect(cores[0].nice == 5ULL);
+    expect(cores[0].system == 75ULL);
+    expect(cores[0].idle == 2250ULL);
+    expect(cores[0].total == 2430ULL);
+    expect(cores[1].idle == 6750ULL);
+
+    // Cut in the middle of a core line
+    expect(!proc_util::parse_stat(data.data(), 50, cores));
+
+    // Cut at the end of a core line, or right after it
+    size_t boundary{data.find("cpu1")};
+    expect(!proc_util::parse_stat(data.data(), boundary, cores));
+    expect(!proc_util::parse_stat(data.data(), boundary + 2, cores));
+    expect(!proc_util::parse_stat(data.data(), data.find("intr"), cores));
+    expect(proc_util::parse_stat(data.data(), data.find("intr") + 3, cores));
+    expect(cores.size() == size_t{2});
+  };
+
+  "parse_meminfo"_test = [] {
+    string data{
+        "MemTotal:       16318480 kB\n"
+        "MemFree:         1203844 kB\n"
+        "MemAvailable:    9877012 kB\n"
+        "Buffers:          715140 kB\n"
+        "Cached:          7830296 kB\n"};
+    proc_util::memory_snapshot memory;
+
+    expect(proc_util::parse_meminfo(data.data(), data.size(), memory));
+    expect(memory.total == 16318480ULL);
+    expect(memory.free == 1203844ULL);
+    expect(memory.available == 9877012ULL);
+
+    // Estimated on kernels without MemAvailable
+    string legacy{
+        "MemTotal:       16318480 kB\n"
+        "MemFree:         1203844 kB\n"
+        "Buffers:          715140 kB\n"
+        "Cached:          7830296 kB\n"};
+
+    expect(proc_util::parse_meminfo(legacy.data(), legacy.size(), memory));
+    expect(memory.available == 1203844ULL + 715140ULL + 7830296ULL);
+
+    expect(!proc_util::parse_meminfo("", 0, memory));
+  };
+
+  "sampler"_test = [] {
+    char stat_path[]{"/tmp/polybar-test-stat-XXXXXX"};
+    char meminfo_path[]{"/tmp/polybar-test-meminfo-XXXXXX"};
+    close(mkstemp(stat_path));
+    close(mkstemp(meminfo_path));
+
+    // More cores than fit in the initial buffer
+    {
+      std::ofstream out{stat_path};
+      out << "cpu  0 0 0 0\n";
+      for (int i = 0; i < 256; i++) {
+        out << "cpu" << i << " 1 2 3 " << i << " 0 0 0 0 0 0\n";
+      }
+      out << "intr 0\n";
+    }
+    {
+      std::ofstream out{meminfo_path};
+      out << "MemTotal: 1000 kB\nMemFree: 200 kB\nMemAvailable: 400 kB\n";
+    }
+
+    proc_util::sampler sampler{stat_path, meminfo_path};
+
+    auto cpu = sampler.cpu();
+    expect(cpu->cores.size() == size_t{256});
+    expect(cpu->cores[255].idle == 255ULL);
+    expect(sampler.cpu() == cpu);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds{5});
+    auto next = sampler.cpu(proc_util::sampler::duration_t{1});
+    expect(next != cpu);
+    expect(next->cores.size() == size_t{256});
+
+    auto memory = sampler.memory();
+    expect(memory->total == 1000ULL);
+    expect(memory->available == 400ULL);
+    expect(sampler.memory() == memory);
+    expect(sampler.reads() == size_t{3});
+
+    unlink(stat_path);
+    unlink(meminfo_path);
+  };
+}
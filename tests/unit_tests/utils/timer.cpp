@@ -0,0 +1,89 @@
+#include <algorithm>
+#include <cstdlib>
+
+#include "utils/timer.cpp"
+
+int main() {
+  using namespace polybar;
+
+  "advance"_test = [] {
+    timer_util::timer_wheel wheel{100};
+    vector<size_t> expired;
+    wheel.add(1, 150);
+    wheel.add(2, 5000);
+    wheel.add(3, 90);
+    expect(wheel.size() == size_t{3});
+
+    wheel.advance(149, expired);
+    expect(expired == vector<size_t>{3});
+
+    wheel.advance(4999, expired);
+    expect(expired == vector<size_t>{3, 1});
+
+    wheel.advance(5000, expired);
+    expect(expired == vector<size_t>{3, 1, 2});
+    expect(wheel.size() == size_t{0});
+  };
+
+  "remove"_test = [] {
+    timer_util::timer_wheel wheel;
+    vector<size_t> expired;
+    wheel.add(1, 10);
+    wheel.add(2, 100000);
+    expect(wheel.remove(2));
+    expect(!wheel.remove(2));
+    wheel.advance(200000, expired);
+    expect(expired == vector<size_t>{1});
+  };
+
+  "next_deadline"_test = [] {
+    timer_util::timer_wheel wheel{1000};
+    uint64_t deadline{0};
+    expect(!wheel.next_deadline(deadline));
+    wheel.add(1, 1000 + 300000);
+    wheel.add(2, 1000 + 7000);
+    expect(wheel.next_deadline(deadline));
+    expect(deadline == 8000);
+    wheel.add(3, 1010);
+    expect(wheel.next_deadline(deadline));
+    expect(deadline == 1010);
+  };
+
+  "random"_test = [] {
+    timer_util::timer_wheel wheel;
+    map<size_t, uint64_t> timers;
+    vector<size_t> expired;
+    uint64_t now{0};
+
+    srand(1);
+
+    for (size_t id = 0; id < 2000; id++) {
+      uint64_t deadline{now + rand() % (1 << (rand() % 28))};
+      wheel.add(id, deadline);
+      timers[id] = deadline;
+
+      if (id % 10 == 0) {
+        uint64_t next{0};
+        expect(wheel.next_deadline(next));
+        uint64_t earliest{UINT64_MAX};
+        for (auto&& t : timers) {
+          earliest = std::min(earliest, t.second);
+        }
+        expect(next == std::max(earliest, now));
+
+        now += rand() % 100000;
+        expired.clear();
+        wheel.advance(now, expired);
+
+        for (auto&& id : expired) {
+          expect(timers.count(id) && timers[id] <= now);
+          timers.erase(id);
+        }
+        for (auto&& t : timers) {
+          expect(t.second > now);
+        }
+        now++;
+      }
+    }
+  };
+}
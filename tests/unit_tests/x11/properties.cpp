@@ -0,0 +1,148 @@
+#include "x11/properties.cpp"
+
+using namespace polybar;
+
+/**
+ * Cache answering requests without a server, counting round-trips
+ */
+class test_cache : public property_cache {
+ public:
+  test_cache() : property_cache(nullptr) {}
+
+  size_t requests{0U};
+  function<void()> during_fetch;
+
+ protected:
+  vector<property_t> fetch(xcb_window_t, const vector<xcb_atom_t>& atoms) override {
+    vector<property_t> values;
+
+    requests++;
+
+    // Simulates an event handled while the requests are in flight
+    if (during_fetch) {
+      during_fetch();
+    }
+
+    for (auto&& atom : atoms) {
+      auto value = make_shared<property>();
+      value->type = atom;
+      value->data = to_string(requests);
+      values.emplace_back(value);
+    }
+
+    return values;
+  }
+};
+
+int main() {
+  const xcb_window_t win{1};
+  const xcb_window_t other{2};
+  const xcb_atom_t name{10};
+  const xcb_atom_t desktop{11};
+
+  "watched"_test = [&] {
+    test_cache cache;
+    cache.watch(win, &cache);
+
+    expect(cache.get(win, name)->data == "1");
+    expect(cache.get(win, name)->data == "1");
+    expect(cache.requests == 1U);
+    expect(cache.hits() == 1U);
+    expect(cache.misses() == 1U);
+
+    // Only the missing value is requested
+    auto values = cache.get(win, {name, desktop});
+    expect(values.size() == 2U);
+    expect(values[0]->data == "1");
+    expect(values[1]->type == desktop);
+    expect(values[1]->data == "2");
+    expect(cache.requests == 2U);
+  };
+
+  "unwatched"_test = [&] {
+    test_cache cache;
+    cache.watch(win, &cache);
+
+    expect(cache.get(other, name)->data == "1");
+    expect(cache.get(other, name)->data == "2");
+    expect(cache.hits() == 0U);
+  };
+
+  "invalidate"_test = [&] {
+    test_cache cache;
+    cache.watch(win, &cache);
+
+    cache.get(win, name);
+    cache.invalidate(win, name);
+    expect(cache.get(win, name)->data == "2");
+    expect(cache.get(win, name)->data == "2");
+
+    // Other properties stay cached
+    cache.get(win, desktop);
+    cache.invalidate(win, name);
+    expect(cache.get(win, desktop)->data == "3");
+  };
+
+  "invalidate_during_fetch"_test = [&] {
+    test_cache cache;
+    cache.watch(win, &cache);
+
+    // The reply may predate the change, so it must not be stored
+    cache.during_fetch = [&] { cache.invalidate(win, name); };
+    expect(cache.get(win, name)->data == "1");
+
+    cache.during_fetch = nullptr;
+    expect(cache.get(win, name)->data == "2");
+    expect(cache.get(win, name)->data == "2");
+    expect(cache.requests == 2U);
+
+    // Any event invalidates the replies in flight
+    cache.during_fetch = [&] { cache.invalidate(other, desktop); };
+    expect(cache.get(win, desktop)->data == "3");
+
+    cache.during_fetch = nullptr;
+    expect(cache.get(win, desktop)->data == "4");
+    expect(cache.get(win, desktop)->data == "4");
+  };
+
+  "unwatch_during_fetch"_test = [&] {
+    test_cache cache;
+    cache.watch(win, &cache);
+
+    cache.during_fetch = [&] { cache.unwatch(win, &cache); };
+    cache.get(win, name);
+
+    cache.during_fetch = nullptr;
+    expect(cache.get(win, name)->data == "2");
+    expect(cache.get(win, name)->data == "3");
+  };
+
+  "watch_refcount"_test = [&] {
+    test_cache cache;
+    int first{0};
+    int second{0};
+
+    cache.watch(win, &first);
+    cache.watch(win, &second);
+    cache.watch(win, &second);
+    cache.get(win, name);
+
+    // Still watched by the first owner
+    cache.unwatch(win, &second);
+    expect(cache.get(win, name)->data == "1");
+
+    // Unknown owners are ignored
+    cache.unwatch(win, &cache);
+    expect(cache.get(win, name)->data == "1");
+
+    // Entries are dropped with the last owner
+    cache.unwatch(win, &first);
+    expect(cache.get(win, name)->data == "2");
+    expect(cache.get(win, name)->data == "3");
+
+    // And cached again once watched
+    cache.watch(win, &first);
+    expect(cache.get(win, name)->data == "4");
+    expect(cache.get(win, name)->data == "4");
+  };
+}